@@ -0,0 +1,138 @@
+// Parse of a file tree with --fast-includes against the full parse: the
+// tree of the arguments, taken as by lazyut, is parsed both ways and the
+// parsed data of every file compared. The scanner gives up on the files
+// which may declare anything, so the data has to be the same. The files
+// left out by --full-parse-extensions are only read for the includes, the
+// differences in those are listed but expected.
+//
+//     include_scan_bench -r <root> -o <outdir> [lazyut options...]
+
+#include <command_line_args.hpp>
+#include <extensions/help_functions.hpp>
+#include <parsers/include_scanner.hpp>
+#include <types/file_tree.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using FileMap = std::unordered_map< std::string, FileNode * >;
+
+double parse(FileTree &tree, bool fastIncludes)
+{
+    tree.setRootPath(clargs.rootDirectory());
+    tree.setJobs(clargs.jobs());
+    tree.setFastIncludes(fastIncludes, clargs.fullParseExtensions());
+
+    tree.readFiles(clargs);
+    tree.calculateFileHashes();
+    tree.addIncludePaths(clargs.includePaths());
+
+    const auto start = std::chrono::steady_clock::now();
+    tree.parseFiles();
+    const std::chrono::duration< double > elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+void collectSourceFiles(FileNode *node, FileMap &files)
+{
+    if (node->isSourceFile())
+        files.emplace(node->fullPath().jointUnix(), node);
+    for (FileNode *child : node->childs())
+        collectSourceFiles(child, files);
+}
+
+bool sameIncludes(const FileRecord &lhs, const FileRecord &rhs)
+{
+    if (lhs._listIncludes.size() != rhs._listIncludes.size())
+        return false;
+    for (size_t i = 0; i < lhs._listIncludes.size(); ++i) {
+        const IncludeDirective &l = lhs._listIncludes[i];
+        const IncludeDirective &r = rhs._listIncludes[i];
+        if (l.type != r.type || l.filename != r.filename)
+            return false;
+    }
+    return true;
+}
+
+bool sameParsedData(const FileRecord &lhs, const FileRecord &rhs)
+{
+    return sameIncludes(lhs, rhs) && lhs._setImplements == rhs._setImplements &&
+           lhs._setClassDecl == rhs._setClassDecl &&
+           lhs._setFuncDecl == rhs._setFuncDecl &&
+           lhs._setInheritances == rhs._setInheritances &&
+           lhs._listUsingNamespace == rhs._listUsingNamespace;
+}
+
+// the size of a file --fast-includes doesn't parse, 0 for the others
+size_t scannedSize(const FileTree &tree, FileNode *node,
+                   IncludeScanner &scanner)
+{
+    const FileData content =
+        readFile(node->fullPath().jointOs().c_str(), "r");
+    if (!content.data)
+        return 0;
+    std::vector< IncludeDirective > includes;
+    if (tree.mayDeclare(node->name()) &&
+        !scanner.scan(content.data.get(), content.size, includes))
+        return 0;
+    return std::max< size_t >(content.size, 1);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    clargs.parseArguments(argc, argv);
+    if (clargs.status() != CommandLineArgs::Success)
+        return clargs.retCode();
+
+    FileTree full;
+    FileTree fast;
+    const double fullTime = parse(full, false);
+    const double fastTime = parse(fast, true);
+
+    FileMap fullFiles, fastFiles;
+    collectSourceFiles(full.rootNode(), fullFiles);
+    collectSourceFiles(fast.rootNode(), fastFiles);
+
+    IncludeScanner scanner;
+    size_t scanned = 0;
+    size_t scannedBytes = 0;
+    size_t mismatches = fullFiles.size() != fastFiles.size();
+    for (const auto &file : fullFiles) {
+        auto it = fastFiles.find(file.first);
+        if (it == fastFiles.end()) {
+            std::cout << "missing: " << file.first << std::endl;
+            ++mismatches;
+        }
+        else if (!fast.mayDeclare(file.second->name())) {
+            // where the parser loses its way in the declarations the
+            // scanner may find more
+            if (!sameIncludes(file.second->record(), it->second->record()))
+                std::cout << "includes differ: " << file.first << std::endl;
+        }
+        else if (!sameParsedData(file.second->record(),
+                                 it->second->record())) {
+            std::cout << "differs: " << file.first << std::endl;
+            ++mismatches;
+        }
+        if (size_t size = scannedSize(fast, file.second, scanner)) {
+            ++scanned;
+            scannedBytes += size;
+        }
+    }
+
+    std::cout << fullFiles.size() << " files, " << scanned << " of "
+              << scannedBytes / 1024 << " KiB read for the includes only"
+              << std::endl;
+    std::cout << "full parse " << fullTime << " s, --fast-includes "
+              << fastTime << " s" << std::endl;
+    return mismatches ? 1 : 0;
+}
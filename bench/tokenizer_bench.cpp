@@ -0,0 +1,136 @@
+// Classification of the tokens of the given files: the key word hash and
+// the symbol automaton of the tokenizer against the linear search of the
+// token maps (tok()) and the symbol tree which were used before.
+//
+//     tokenizer_bench <source files...>
+
+#include <extensions/help_functions.hpp>
+#include <parsers/tokenizer.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const int rounds = 20;
+// the longest symbol and the byte after it
+const size_t symbolText = 4;
+
+TreeNode< char > initSymbolTree()
+{
+    TreeNode< char > root;
+    for (int i = 0; i < special_symbols.size(); ++i) {
+        const char *str = special_symbols[i].second;
+        root.insert(str, strlen(str));
+    }
+    return root;
+}
+
+TokenName treeSymbol(const TreeNode< char > &tree, const std::string &text)
+{
+    size_t length = 0;
+    const TreeNode< char > *node = &tree;
+    while (length < text.size()) {
+        const TreeNode< char > *next = node->find(text[length]);
+        if (!next)
+            break;
+        node = next;
+        ++length;
+    }
+    while (!node->finite)
+        node = tree.find(text.data(), --length);
+    return tok(text.data(), length);
+}
+
+TokenName automatonSymbol(const std::string &text)
+{
+    TokenName name = TokenName::Undefined;
+    SymbolAutomaton::State state = SymbolAutomaton::root;
+    for (char ch : text) {
+        state = symbol_automaton.next(state, ch);
+        if (state == SymbolAutomaton::dead)
+            break;
+        if (symbol_automaton.accepted(state) != TokenName::Undefined)
+            name = symbol_automaton.accepted(state);
+    }
+    return name;
+}
+
+template < typename TFunc >
+double measure(const std::vector< std::string > &lexemes,
+               std::vector< TokenName > &names, TFunc f)
+{
+    names.assign(lexemes.size(), TokenName::Undefined);
+    const auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        for (size_t i = 0; i < lexemes.size(); ++i)
+            names[i] = f(lexemes[i]);
+    }
+    const std::chrono::duration< double, std::nano > elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / rounds / std::max< size_t >(lexemes.size(), 1);
+}
+
+bool report(const char *what, const std::vector< std::string > &lexemes,
+            double before, double after,
+            const std::vector< TokenName > &expected,
+            const std::vector< TokenName > &names)
+{
+    std::cout << what << ": " << lexemes.size() << " tokens, " << before
+              << " ns before, " << after << " ns now" << std::endl;
+    if (names == expected)
+        return true;
+    std::cout << what << ": the results differ" << std::endl;
+    return false;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    std::vector< std::string > words;
+    std::vector< std::string > symbols;
+
+    Tokenizer tokenizer;
+    for (int i = 1; i < argc; ++i) {
+        const FileData content = readFile(argv[i], "r");
+        if (!content.data)
+            continue;
+        tokenizer.open(SplittedPath(argv[i], SplittedPath::osSep()), content);
+        Token token(TokenName::Undefined, 0, 0);
+        while (tokenizer.next(token)) {
+            if (token.name == TokenName::String)
+                continue;
+            if (token.name == TokenName::Identifier || token.isKeyWord()) {
+                words.emplace_back(tokenizer.lexeme(token), token.length);
+                continue;
+            }
+            symbols.emplace_back(
+                tokenizer.lexeme(token),
+                std::min(symbolText, content.size - token.offset));
+        }
+    }
+
+    const TreeNode< char > tree = initSymbolTree();
+    std::vector< TokenName > expected, names;
+
+    double before = measure(words, expected, [](const std::string &word) {
+        return tok(word.data(), word.size());
+    });
+    double after = measure(words, names, [](const std::string &word) {
+        return key_word_table.find(word.data(), word.size());
+    });
+    bool same = report("words", words, before, after, expected, names);
+
+    before = measure(symbols, expected, [&tree](const std::string &text) {
+        return treeSymbol(tree, text);
+    });
+    after = measure(symbols, names, automatonSymbol);
+    same = report("symbols", symbols, before, after, expected, names) && same;
+
+    return same ? 0 : 1;
+}
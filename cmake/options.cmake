@@ -40,3 +40,4 @@ set(DEP_PARSER_TARGET_NAME dep_parser)
 ## OPTIONS
 ##
 option(BUILD_TESTS          "Build tests"                                                   OFF)
+option(BUILD_BENCHMARKS     "Build benchmarks"                                              OFF)
@@ -11,6 +11,7 @@ message( STATUS )
 message( STATUS "---------------------------------------------------------" )
 message( STATUS )
 message( STATUS "BUILD_TESTS =           ${BUILD_TESTS}" )
+message( STATUS "BUILD_BENCHMARKS =      ${BUILD_BENCHMARKS}" )
 message( STATUS )
 message( STATUS "Change a value with: cmake -D<Variable>=<Value>" )
 message( STATUS )
@@ -1,6 +1,10 @@
+#include <changed_files_reader.hpp>
 #include <command_line_args.hpp>
+#include <extensions/error_reporter.hpp>
 #include <extensions/flatbuffers_extensions.hpp>
 #include <extensions/help_functions.hpp>
+#include <server.hpp>
+#include <watcher.hpp>
 
 #include <iostream>
 
@@ -16,18 +20,41 @@ int main(int argc, char *argv[])
     if (clargs.status() != CommandLineArgs::Success)
         return clargs.retCode();
 
+    if (clargs.isServe())
+        return Server(clargs).run();
+    if (clargs.isWatch())
+        return Watcher(clargs).run();
+
     START_PROFILE;
 
     FileTree rootTree;
     rootTree.setRootPath(clargs.rootDirectory());
+    rootTree.setJobs(clargs.jobs());
+    rootTree.setTrustMtime(clargs.isTrustMtime());
+    rootTree.setHashAlgorithm(clargs.hashAlgorithm());
+    rootTree.setFastIncludes(clargs.isFastIncludes(),
+                             clargs.fullParseExtensions());
 
     PROFILE(rootTree.readFiles(clargs));
 
+    PROFILE(rootTree.restoreSnapshot(clargs.ftreeDumpIn()));
+
+    if (clargs.isChangedFrom()) {
+        std::vector< SplittedPath > changedFiles;
+        if (ChangedFilesReader().read(clargs.changedFrom(),
+                                      clargs.rootDirectory(), changedFiles))
+            rootTree.setChangedFiles(changedFiles);
+        else
+            errors() << "warning: every file is read";
+    }
+
+    PROFILE(rootTree.calculateFileHashes());
+
     rootTree.addIncludePaths(clargs.includePaths());
 
     rootTree.installExtraDependencies(clargs.extraDeps());
 
-    PROFILE(rootTree.parsePhase(clargs.ftreeDumpIn()));
+    PROFILE(rootTree.parsePhase());
 
     PROFILE(rootTree.analyzePhase());
 
@@ -0,0 +1,100 @@
+#include "changed_files_reader.hpp"
+
+#include "extensions/error_reporter.hpp"
+#include "extensions/help_functions.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+#ifdef WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+static std::string shellQuote(const std::string &arg)
+{
+#ifdef WIN32
+    return '"' + arg + '"';
+#else
+    std::string result("'");
+    for (char ch : arg) {
+        if (ch == '\'')
+            result += "'\\''";
+        else
+            result += ch;
+    }
+    return result + '\'';
+#endif
+}
+
+bool ChangedFilesReader::read(const std::string &source,
+                              const SplittedPath &root,
+                              std::vector< SplittedPath > &paths)
+{
+    if (is_file(source.c_str()))
+        return readList(source, paths);
+
+    if (source.empty() || source[0] == '-') {
+        errors() << "error: --changed-from" << source
+                 << "is neither a file nor a revision";
+        return false;
+    }
+    // paths relative to the root, files outside of it are left out;
+    // nothing is appended unless both commands succeed
+    const std::string git = "git -C " + shellQuote(root.jointOs());
+    std::vector< SplittedPath > changed;
+    if (!readGit(git + " diff -z --name-only --no-renames --relative " +
+                     shellQuote(source) + " --",
+                 changed) ||
+        !readGit(git + " ls-files -z --others", changed))
+        return false;
+    paths.insert(paths.end(), changed.begin(), changed.end());
+    return true;
+}
+
+bool ChangedFilesReader::readList(const std::string &fname,
+                                  std::vector< SplittedPath > &paths)
+{
+    std::ifstream ifs(fname);
+    if (!ifs.is_open()) {
+        errors() << "error: can't open" << fname;
+        return false;
+    }
+    std::string line;
+    while (std::getline(ifs, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (!line.empty())
+            paths.push_back(SplittedPath(line, SplittedPath::unixSep()));
+    }
+    return true;
+}
+
+bool ChangedFilesReader::readGit(const std::string &command,
+                                 std::vector< SplittedPath > &paths)
+{
+    FILE *pipe = popen(command.c_str(), "r");
+    if (!pipe) {
+        errors() << "error: can't run" << command;
+        return false;
+    }
+    // -z: paths are NUL terminated and never quoted
+    std::string output;
+    char buffer[4096];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), pipe)) > 0)
+        output.append(buffer, count);
+    if (pclose(pipe) != 0) {
+        errors() << "error:" << command << "failed";
+        return false;
+    }
+
+    size_t begin = 0;
+    for (size_t end; (end = output.find('\0', begin)) != std::string::npos;
+         begin = end + 1) {
+        if (end > begin)
+            paths.push_back(SplittedPath(output.substr(begin, end - begin),
+                                         SplittedPath::unixSep()));
+    }
+    return true;
+}
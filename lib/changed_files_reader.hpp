@@ -0,0 +1,29 @@
+#ifndef CHANGED_FILES_READER_HPP
+#define CHANGED_FILES_READER_HPP
+
+#include "types/splitted_string.hpp"
+
+#include <string>
+#include <vector>
+
+// Paths changed since the dump given by --ftree-in was written,
+// see --changed-from. The source is either a file listing the paths one
+// per line, relative to the root, or the git revision the dump was written
+// at. For a revision the local repository is asked for the tracked files
+// differing from it and for the untracked files, it can't tell whether
+// they changed.
+class ChangedFilesReader
+{
+public:
+    // false if the changes can't be read
+    bool read(const std::string &source, const SplittedPath &root,
+              std::vector< SplittedPath > &paths);
+
+private:
+    bool readList(const std::string &fname,
+                  std::vector< SplittedPath > &paths);
+    bool readGit(const std::string &command,
+                 std::vector< SplittedPath > &paths);
+};
+
+#endif // CHANGED_FILES_READER_HPP
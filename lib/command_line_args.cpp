@@ -1,5 +1,6 @@
 #include "command_line_args.hpp"
 #include "directoryreader.hpp"
+#include "extensions/parallel.hpp"
 
 #include "external/CLI11/CLI11.hpp"
 
@@ -12,7 +13,9 @@ std::string CommandLineArgs::_totalAffectedFileName = "total_affected.txt";
 CommandLineArgs clargs;
 
 CommandLineArgs::CommandLineArgs()
-    : _verbal(false), _isNoMain(false), _verbosityLevel(0), _retCode(0)
+    : _verbal(false), _isNoMain(false), _verbosityLevel(0), _jobs(0),
+      _isTrustMtime(false), _hashAlgorithm(ContentHasher::defaultAlgorithm),
+      _isFastIncludes(false), _isWatch(false), _retCode(0)
 {
 }
 
@@ -33,6 +36,10 @@ void CommandLineArgs::parseArguments(int argc, char *argv[])
     std::string extra_dependencies;
 
     std::string ignoredOutput;
+    std::string serveSocket;
+
+    std::string hashAlgorithm("murmur3");
+    const auto hashAlgorithmNames = ContentHasher::names();
 
     // required arguments
     app.add_option("-r,--root", rootDir,
@@ -73,10 +80,40 @@ void CommandLineArgs::parseArguments(int argc, char *argv[])
                    "separated by comma (,)");
     app.add_option("--verbosity-level", _verbosityLevel,
                    "From 0 to 2, the higher is more verbose");
+    app.add_option("-j,--jobs", _jobs,
+                   "Number of worker threads, "
+                   "by default the number of hardware threads");
+    app.add_set("--hash-algorithm", hashAlgorithm,
+                std::set< std::string >(hashAlgorithmNames.begin(),
+                                        hashAlgorithmNames.end()),
+                "Hash of the file contents, by default murmur3, "
+                "changing it rehashes and reparses every file");
+    app.add_option("--serve", serveSocket,
+                   "Keep the file tree in memory and answer which tests are "
+                   "affected by the listed files over this UNIX socket");
+    app.add_option("--changed-from", _changedFrom,
+                   "File listing the changed paths relative to Root, or "
+                   "the git revision the input file tree was written at; "
+                   "other files are taken as unchanged and aren't read");
+    app.add_option("--full-parse-extensions", _fullParseExtensions,
+                   "With --fast-includes, only the files of these extensions "
+                   "are parsed for declarations, the others are read for "
+                   "the include directives only; separated by comma (,), "
+                   "by default every extension. Unchanged files keep the "
+                   "parsed data of the input file tree");
 
     app.add_flag("-m,--no-main", _isNoMain,
                  "Don't keep test source file with main() implementation");
     app.add_flag("-v,--verbal", _verbal, "Verbal mode");
+    app.add_flag("--trust-mtime", _isTrustMtime,
+                 "Don't read files whose mtime, size and inode match "
+                 "the previous run, reuse their hash");
+    app.add_flag("--fast-includes", _isFastIncludes,
+                 "Read only the include directives of the files which "
+                 "can't declare classes or functions, without parsing them");
+    app.add_flag("--watch", _isWatch,
+                 "Keep running and rewrite the output whenever the files "
+                 "in the source and test directories change");
     //
 
     try {
@@ -88,6 +125,8 @@ void CommandLineArgs::parseArguments(int argc, char *argv[])
         return;
     }
 
+    ContentHasher::fromName(hashAlgorithm, _hashAlgorithm);
+
     if (!exts.empty())
         DirectoryReader::_sourceFileExtensions = split(exts, ",");
 
@@ -131,10 +170,19 @@ void CommandLineArgs::parseArguments(int argc, char *argv[])
 
     _ignoredOutput = split(ignoredOutput, ",");
 
+    _serveSocket = SplittedPath(serveSocket, SplittedPath::unixSep());
+
     _status = Success;
     _retCode = 0;
 }
 
+unsigned CommandLineArgs::jobs() const
+{
+    if (_jobs == 0)
+        return hardwareJobs();
+    return _jobs;
+}
+
 SplittedPath CommandLineArgs::testFilesPath() const
 {
     auto tmp = _outDirectory;
@@ -158,6 +206,11 @@ std::vector< SplittedPath > CommandLineArgs::testDirectories() const
     return tmp;
 }
 
+CommandLineArgs::StringVector CommandLineArgs::fullParseExtensions() const
+{
+    return split(_fullParseExtensions, ",");
+}
+
 CommandLineArgs::StringVector CommandLineArgs::testPatterns() const
 {
     return split(_testPatterns, ",");
@@ -1,6 +1,7 @@
 #ifndef COMMAND_LINE_ARGS_HPP
 #define COMMAND_LINE_ARGS_HPP
 
+#include "extensions/content_hasher.hpp"
 #include "types/splitted_string.hpp"
 
 class CommandLineArgs
@@ -28,6 +29,22 @@ public:
 
     bool isNoMain() const { return _isNoMain; }
 
+    unsigned jobs() const;
+    bool isTrustMtime() const { return _isTrustMtime; }
+    ContentHasher::Algorithm hashAlgorithm() const { return _hashAlgorithm; }
+    // read only the include directives of files which declare nothing
+    bool isFastIncludes() const { return _isFastIncludes; }
+    StringVector fullParseExtensions() const;
+
+    // answer queries over the UNIX socket instead of a single run
+    bool isServe() const { return !_serveSocket.empty(); }
+    const SplittedPath &serveSocket() const { return _serveSocket; }
+    // keep the output up to date while the sources change
+    bool isWatch() const { return _isWatch; }
+    // file listing the changed paths or git revision of --ftree-in
+    bool isChangedFrom() const { return !_changedFrom.empty(); }
+    const std::string &changedFrom() const { return _changedFrom; }
+
     const SplittedPath &ftreeDumpIn() const { return _ftreeDumpIn; }
     const SplittedPath &ftreeDumpOut() const { return _ftreeDumpOut; }
     const SplittedPath &srcsAffected() const { return _srcsAffected; }
@@ -73,6 +90,16 @@ private:
 
     bool _isNoMain;
 
+    unsigned _jobs;
+    bool _isTrustMtime;
+    ContentHasher::Algorithm _hashAlgorithm;
+    bool _isFastIncludes;
+    std::string _fullParseExtensions;
+
+    SplittedPath _serveSocket;
+    bool _isWatch;
+    std::string _changedFrom;
+
     static std::string _rootFTreeFilename;
     static std::string _srcsAffectedFileName;
     static std::string _testsAffectedFileName;
@@ -1,86 +1,140 @@
 #include "dependency_analyzer.hpp"
 
-HashedStringNode::HashedStringNode(const HashedString &hs_)
-    : hs(hs_), parent(nullptr)
+#include <algorithm>
+#include <cstring>
+
+static void appendName(std::string &key, const HashedFileName &part)
 {
+    if (!key.empty())
+        key += ScopedName::namespaceSep();
+    key += part.str();
 }
 
-HashedStringNode::~HashedStringNode()
+DeclarationIndex::DeclarationIndex(const std::string &name)
+    : _stored(nullptr), _files(nullptr), _parsed(name)
 {
-    // memory free
-    for (auto const &m : childs)
-        delete m.second;
 }
 
-HashedStringNode *HashedStringNode::findOrNew(const HashedString &key)
+void DeclarationIndex::restore(const StoredDeclarations &stored,
+                               const FileTree::FileIdMap &files)
 {
-    if (HashedStringNode *node = find(key))
-        return node;
-
-    HashedStringNode *node = new HashedStringNode(key);
-    node->parent = this;
-    childs.insert(std::make_pair(key.hash(), node));
-    return node;
+    _stored = &stored;
+    _files = &files;
 }
 
-HashedStringNode *HashedStringNode::find(const HashedString &key) const
+bool DeclarationIndex::isRestored(const FileNode *file) const
 {
-    auto it = childs.find(key.hash());
-    if (it == childs.end())
-        return nullptr;
-    return it->second;
+    return _stored && file->record().isUnchanged();
 }
 
-HashedStringNode *HashedStringNode::findSplitted(
-    const HashedStringNode::TSplittedString &splittedString)
+void DeclarationIndex::insert(const ScopedName &name, FileNode *file)
 {
-    HashedStringNode *current_node = this;
-    for (const auto &s : splittedString.splitted()) {
-        current_node = current_node->find(s);
-        if (current_node == nullptr)
-            return nullptr;
-    }
-    return current_node;
+    _parsed.insert(name, file);
 }
 
-HashedStringNode::TSplittedString HashedStringNode::fullname() const
+bool DeclarationIndex::find(const ScopedName &scope, const ScopedName &name,
+                            size_t count, Files &files) const
 {
-    TSplittedString result;
-    result.setNamespaceSeparator();
-
-    const HashedStringNode *n = this;
-    while (n) {
-        result.prepend(n->hs);
-        n = n->parent;
+    assert(count <= name.splitted().size());
+    files.clear();
+
+    NameTrie::Node node = _parsed.findSplitted(scope);
+    for (size_t i = 0; node != NameTrie::noNode && i < count; ++i)
+        node = _parsed.find(node, name.splitted()[i]);
+    bool found = node != NameTrie::noNode;
+    if (found)
+        _parsed.appendFiles(node, files);
+
+    if (!_stored)
+        return found;
+
+    std::string key;
+    for (const auto &part : scope.splitted())
+        appendName(key, part);
+    for (size_t i = 0; i < count; ++i)
+        appendName(key, name.splitted()[i]);
+
+    if (const LazyUT::Declaration *decl = _stored->LookupByKey(key.c_str())) {
+        found = true;
+        if (decl->files()) {
+            for (uint32_t id : *decl->files()) {
+                if (isKept(id))
+                    files.push_back(_files->find(id)->second);
+            }
+        }
+        return found;
+    }
+    if (found)
+        return found;
+
+    // names in the scope of the key go together
+    key += ScopedName::namespaceSep();
+    flatbuffers::uoffset_t first = 0;
+    flatbuffers::uoffset_t last = _stored->size();
+    while (first < last) {
+        const flatbuffers::uoffset_t middle = first + (last - first) / 2;
+        if (strcmp(_stored->Get(middle)->name()->c_str(), key.c_str()) < 0)
+            first = middle + 1;
+        else
+            last = middle;
     }
-    return result;
+    return first < _stored->size() &&
+           strncmp(_stored->Get(first)->name()->c_str(), key.c_str(),
+                   key.size()) == 0;
 }
 
-void HashedStringNode::print(int indent)
+void DeclarationIndex::forEach(
+    const std::function< void(const std::string &,
+                              const std::vector< uint32_t > &) > &f) const
 {
-    std::string strIndents = makeIndents(indent, 0);
-
-    std::cout << strIndents << hs << std::endl;
-    for (const auto &fn : data)
-        std::cout << strIndents << "-- " << fn->name() << std::endl;
-
-    for (const auto &x : childs)
-        x.second->print(indent + 1);
+    std::vector< std::pair< std::string, std::vector< uint32_t > > > parsed;
+    _parsed.forEach([&](const std::string &name, const Files &files) {
+        std::vector< uint32_t > ids;
+        for (const FileNode *file : files)
+            ids.push_back(file->record()._id);
+        parsed.emplace_back(name, std::move(ids));
+    });
+    std::sort(parsed.begin(), parsed.end());
+
+    // merge of the sorted names, the stored ones are the most of them
+    auto it = parsed.begin();
+    std::vector< uint32_t > ids;
+    if (_stored) {
+        for (const LazyUT::Declaration *decl : *_stored) {
+            const char *name = decl->name()->c_str();
+            for (; it != parsed.end() && strcmp(it->first.c_str(), name) < 0;
+                 ++it)
+                f(it->first, it->second);
+
+            ids.clear();
+            if (decl->files()) {
+                for (uint32_t id : *decl->files()) {
+                    if (isKept(id))
+                        ids.push_back(id);
+                }
+            }
+            if (it != parsed.end() && it->first == name) {
+                ids.insert(ids.end(), it->second.begin(), it->second.end());
+                ++it;
+            }
+            if (!ids.empty())
+                f(decl->name()->str(), ids);
+        }
+    }
+    for (; it != parsed.end(); ++it)
+        f(it->first, it->second);
 }
 
-void HashedStringNode::insert(
-    const HashedStringNode::TSplittedString &splittedString, FileNode *fnode)
+bool DeclarationIndex::isKept(uint32_t id) const
 {
-    HashedStringNode *current_node = this;
-    for (const auto &s : splittedString.splitted())
-        current_node = current_node->findOrNew(s);
-
-    current_node->data.push_back(fnode);
+    // the changed files are in the trie
+    auto it = _files->find(id);
+    return it != _files->end() && it->second->record().isUnchanged();
 }
 
-DependencyAnalyzer::DependencyAnalyzer()
-    : _rootClassDecls(std::string("CLASSES")),
-      _rootFuncDecls(std::string("GLOBAL FUNCTIONS"))
+DependencyAnalyzer::DependencyAnalyzer(DeclarationIndex &classDecls,
+                                       DeclarationIndex &funcDecls)
+    : _classDecls(classDecls), _funcDecls(funcDecls)
 {
 }
 
@@ -96,30 +150,29 @@ void DependencyAnalyzer::analyze(FileNode *fnode)
 void DependencyAnalyzer::print()
 {
     /// DEBUG
-    _rootClassDecls.print();
-    _rootFuncDecls.print();
+    _classDecls.print();
+    _funcDecls.print();
 }
 
 void DependencyAnalyzer::analyzeImpl(const ScopedName &impl, FileNode *fnode)
 {
-    HashedStringNode *associatedDecl;
+    DeclarationIndex::Files files;
 
-    if (associatedDecl = _rootFuncDecls.findSplitted(impl)) {
+    if (_funcDecls.find(ScopedName(), impl, impl.splitted().size(), files)) {
         // global function implementation
-        addFunctionImpl(fnode, associatedDecl);
+        addFunctionImpl(fnode, files);
         return;
     }
-    if (associatedDecl = findClassForMethod(impl, fnode, &_rootClassDecls)) {
+    if (findClassForMethod(impl, ScopedName(), files)) {
         // no namespace
-        addClassImpl(fnode, associatedDecl);
+        addClassImpl(fnode, files);
         return;
     }
     // check for method implementation
     // according to using namespaces
     for (auto &ns : fnode->record()._listUsingNamespace) {
-        if (associatedDecl = findClassForMethod(
-                impl, fnode, _rootClassDecls.findSplitted(ns))) {
-            addClassImpl(fnode, associatedDecl);
+        if (findClassForMethod(impl, ns, files)) {
+            addClassImpl(fnode, files);
             return;
         }
     }
@@ -128,96 +181,83 @@ void DependencyAnalyzer::analyzeImpl(const ScopedName &impl, FileNode *fnode)
 void DependencyAnalyzer::analyzeInheritance(const ScopedName &baseClass,
                                             FileNode *fnode)
 {
-    HashedStringNode *associatedDecl;
+    DeclarationIndex::Files files;
 
-    if (associatedDecl = findClass(baseClass, fnode, &_rootClassDecls)) {
+    if (findClass(baseClass, ScopedName(), files)) {
         // no namespace
-        addClassInheritance(fnode, associatedDecl);
+        addClassInheritance(fnode, files);
         return;
     }
     // check for method implementation
     // according to using namespaces
     for (auto &ns : fnode->record()._listUsingNamespace) {
-        if (associatedDecl =
-                findClass(baseClass, fnode, _rootClassDecls.findSplitted(ns))) {
-            addClassInheritance(fnode, associatedDecl);
+        if (findClass(baseClass, ns, files)) {
+            addClassInheritance(fnode, files);
             return;
         }
     }
 }
 
-HashedStringNode *
-DependencyAnalyzer::findClassForMethod(const ScopedName &impl, FileNode *fnode,
-                                       HashedStringNode *hsnode)
+bool DependencyAnalyzer::findClassForMethod(const ScopedName &impl,
+                                            const ScopedName &scope,
+                                            DeclarationIndex::Files &files)
 {
-    return findScopedPrivate(impl, fnode, hsnode, SearchMethod);
+    return findScopedPrivate(impl, scope, SearchMethod, files);
 }
 
-HashedStringNode *DependencyAnalyzer::findClass(const ScopedName &impl,
-                                                FileNode *fnode,
-                                                HashedStringNode *hsnode)
+bool DependencyAnalyzer::findClass(const ScopedName &impl,
+                                   const ScopedName &scope,
+                                   DeclarationIndex::Files &files)
 {
-    return findScopedPrivate(impl, fnode, hsnode, SearchClass);
+    return findScopedPrivate(impl, scope, SearchClass, files);
 }
 
-HashedStringNode *
-DependencyAnalyzer::findScopedPrivate(const ScopedName &impl, FileNode *fnode,
-                                      HashedStringNode *hsnode,
-                                      DependencyAnalyzer::SearchType st)
+bool DependencyAnalyzer::findScopedPrivate(const ScopedName &impl,
+                                           const ScopedName &scope,
+                                           DependencyAnalyzer::SearchType st,
+                                           DeclarationIndex::Files &files)
 {
-    if (nullptr == hsnode)
-        return nullptr;
     const auto &splitted = impl.splitted();
 
-    int i = 0;
-    int size;
+    size_t size;
     switch (st) {
     case SearchClass:
         size = splitted.size();
         break;
     case SearchMethod:
-        size = splitted.size() - 1;
+        // the scope itself for the names without one
+        size = splitted.empty() ? 0 : splitted.size() - 1;
         break;
     default:
         assert(false);
-        return nullptr;
+        return false;
     }
 
-    auto it = splitted.cbegin();
-    for (int i = 0; i < size; ++i, ++it) {
-        hsnode = hsnode->find(*it);
-        if (hsnode == nullptr)
-            return nullptr;
-    }
-
-    return hsnode;
+    return _classDecls.find(scope, impl, size, files);
 }
 
 void DependencyAnalyzer::addFunctionImpl(FileNode *implNode,
-                                         HashedStringNode *hsnode)
+                                         const DeclarationIndex::Files &files)
 {
-    auto &listNodes = hsnode->data;
-    for (auto &&node : listNodes) {
+    for (auto &&node : files) {
         implNode->record()._setImplementFiles.insert(node->path());
         implNode->record()._setFuncImplFiles.insert(node->path());
     }
 }
 
 void DependencyAnalyzer::addClassImpl(FileNode *implNode,
-                                      HashedStringNode *hsnode)
+                                      const DeclarationIndex::Files &files)
 {
-    auto &listNodes = hsnode->data;
-    for (auto &&node : listNodes) {
+    for (auto &&node : files) {
         implNode->record()._setImplementFiles.insert(node->path());
         implNode->record()._setClassImplFiles.insert(node->path());
     }
 }
 
-void DependencyAnalyzer::addClassInheritance(FileNode *implNode,
-                                             HashedStringNode *hsnode)
+void DependencyAnalyzer::addClassInheritance(
+    FileNode *implNode, const DeclarationIndex::Files &files)
 {
-    auto &listNodes = hsnode->data;
-    for (auto &&node : listNodes)
+    for (auto &&node : files)
         implNode->record()._setBaseClassFiles.insert(node->path());
 }
 
@@ -226,10 +266,15 @@ void DependencyAnalyzer::readDecls(FileNode *fnode)
     auto &classDecls = fnode->record()._setClassDecl;
     auto &functionDecls = fnode->record()._setFuncDecl;
 
-    for (const auto &hs : classDecls)
-        _rootClassDecls.insert(hs, fnode);
-    for (const auto &hs : functionDecls)
-        _rootFuncDecls.insert(hs, fnode);
+    // restored from the dump otherwise
+    if (!_classDecls.isRestored(fnode)) {
+        for (const auto &hs : classDecls)
+            _classDecls.insert(hs, fnode);
+    }
+    if (!_funcDecls.isRestored(fnode)) {
+        for (const auto &hs : functionDecls)
+            _funcDecls.insert(hs, fnode);
+    }
 
     for (const auto &chnode : fnode->childs())
         readDecls(chnode);
@@ -237,15 +282,19 @@ void DependencyAnalyzer::readDecls(FileNode *fnode)
 
 void DependencyAnalyzer::analyzeDecls(FileNode *fnode)
 {
-    auto &impls = fnode->record()._setImplements;
-    auto &inheritances = fnode->record()._setInheritances;
+    // restored from the snapshot otherwise
+    if (!fnode->hasStoredAnalysis())
+        analyzeFile(fnode);
 
-    for (const auto &impl : impls)
+    for (auto &&chnode : fnode->childs())
+        analyzeDecls(chnode);
+}
+
+void DependencyAnalyzer::analyzeFile(FileNode *fnode)
+{
+    for (const auto &impl : fnode->record()._setImplements)
         analyzeImpl(impl, fnode);
 
-    for (const auto &inh : inheritances)
+    for (const auto &inh : fnode->record()._setInheritances)
         analyzeInheritance(inh, fnode);
-
-    for (auto &&chnode : fnode->childs())
-        analyzeDecls(chnode);
 }
@@ -2,44 +2,64 @@
 #define DEPENDENCY_ANALYZER_HPP
 
 #include "types/file_tree.hpp"
+#include "types/name_trie.hpp"
+#include "flatbuffers_schemes/file_tree_generated.h"
 
-#include <map>
+#include <functional>
 
-struct HashedStringNode
+// Names declared by the files. The index of the previous run is kept in
+// the dump as a table sorted by name and searched in place, only the names
+// of the files parsed in this run are inserted into the trie.
+class DeclarationIndex
 {
-    using ExtraData = std::vector< FileNode * >;
-    using TSplittedString = ScopedName;
-    using MapLeafs = std::map< HashedString::HashType, HashedStringNode * >;
-
-    HashedString hs;
-    MapLeafs childs;
+public:
+    using Files = NameTrie::Files;
+    using StoredDeclarations =
+        flatbuffers::Vector< flatbuffers::Offset< LazyUT::Declaration > >;
 
-    ExtraData data;
+    explicit DeclarationIndex(const std::string &name);
 
-    HashedStringNode(const HashedString &hs_);
-    ~HashedStringNode();
+    // names declared by the unchanged files in the previous run
+    void restore(const StoredDeclarations &stored,
+                 const FileTree::FileIdMap &files);
+    bool isRestored(const FileNode *file) const;
 
-    void insert(const TSplittedString &splittedString, FileNode *fnode);
+    void insert(const ScopedName &name, FileNode *file);
 
-    HashedStringNode *findOrNew(const HashedString &key);
+    // the first count parts of the name, in the scope;
+    // false if neither it nor a name in it is declared
+    bool find(const ScopedName &scope, const ScopedName &name, size_t count,
+              Files &files) const;
 
-    HashedStringNode *find(const HashedString &key) const;
-    HashedStringNode *findSplitted(const TSplittedString &splittedString);
+    // declared names with ids of the files, sorted as the dump needs
+    void forEach(const std::function< void(const std::string &,
+                                           const std::vector< uint32_t > &) >
+                     &f) const;
 
     /// DEBUG
-    TSplittedString fullname() const;
-    HashedStringNode *parent;
-    void print(int indent = 0);
+    void print() { _parsed.print(); }
     ///
+private:
+    bool isKept(uint32_t id) const;
+
+    const StoredDeclarations *_stored;
+    const FileTree::FileIdMap *_files;
+    NameTrie _parsed;
 };
 
 class DependencyAnalyzer
 {
 public:
-    DependencyAnalyzer();
+    DependencyAnalyzer(DeclarationIndex &classDecls,
+                       DeclarationIndex &funcDecls);
 
     void analyze(FileNode *fnode);
 
+    // the declarations of the files under fnode are added to the indexes
+    void readDecls(FileNode *fnode);
+    // the file only, the indexes are read already
+    void analyzeFile(FileNode *fnode);
+
 public:
     /// DEBUG
     void print();
@@ -48,28 +68,26 @@ private:
     void analyzeImpl(const ScopedName &impl, FileNode *fnode);
     void analyzeInheritance(const ScopedName &baseClass, FileNode *fnode);
 
-    HashedStringNode *findClassForMethod(const ScopedName &impl,
-                                         FileNode *fnode,
-                                         HashedStringNode *hsnode);
-    HashedStringNode *findClass(const ScopedName &impl, FileNode *fnode,
-                                HashedStringNode *hsnode);
+    bool findClassForMethod(const ScopedName &impl, const ScopedName &scope,
+                            DeclarationIndex::Files &files);
+    bool findClass(const ScopedName &impl, const ScopedName &scope,
+                   DeclarationIndex::Files &files);
 
     enum SearchType { SearchClass, SearchMethod };
 
-    HashedStringNode *findScopedPrivate(const ScopedName &impl, FileNode *fnode,
-                                        HashedStringNode *hsnode,
-                                        SearchType st);
+    bool findScopedPrivate(const ScopedName &impl, const ScopedName &scope,
+                           SearchType st, DeclarationIndex::Files &files);
 
-    void addFunctionImpl(FileNode *implNode, HashedStringNode *hsnode);
-    void addClassImpl(FileNode *implNode, HashedStringNode *hsnode);
-    void addClassInheritance(FileNode *implNode, HashedStringNode *hsnode);
-
-    void readDecls(FileNode *fnode);
+    void addFunctionImpl(FileNode *implNode,
+                         const DeclarationIndex::Files &files);
+    void addClassImpl(FileNode *implNode, const DeclarationIndex::Files &files);
+    void addClassInheritance(FileNode *implNode,
+                             const DeclarationIndex::Files &files);
 
     void analyzeDecls(FileNode *fnode);
 
-    HashedStringNode _rootClassDecls;
-    HashedStringNode _rootFuncDecls;
+    DeclarationIndex &_classDecls;
+    DeclarationIndex &_funcDecls;
 };
 
 #endif // DEPENDENCY_ANALYZER_HPP
@@ -1,12 +1,18 @@
 #include "directoryreader.hpp"
 #include "extensions/error_reporter.hpp"
 #include "extensions/help_functions.hpp"
+#include "extensions/parallel.hpp"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <fcntl.h>
 #include <dirent.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 
 std::vector< std::string > initSourceFileExtensions()
 {
@@ -29,6 +35,18 @@ std::vector< std::string > DirectoryReader::_sourceFileExtensions =
 std::vector< std::string > DirectoryReader::_ignore_substrings =
     std::vector< std::string >();
 
+DirectoryReader::DirectoryReader()
+    : _jobs(1), _ignored(_ignore_substrings),
+      _sourceExtensions(_sourceFileExtensions)
+{
+}
+
+void DirectoryReader::setIgnoredSubstrings(const StringVector &substrings)
+{
+    _ignore_substrings = substrings;
+    _ignored = SubstringMatcher(substrings);
+}
+
 void DirectoryReader::setTestPatterns(
     const DirectoryReader::StringVector &patterns)
 {
@@ -53,24 +71,15 @@ void DirectoryReader::readSources(const SplittedPath &relPath, FileNode *parent)
     }
     const auto &splitted = relPath.splitted();
     if (splitted.empty()) {
-        SplittedPath dirPath = parent->fullPath();
-        if (!is_directory(dirPath.jointOs().c_str()))
-            return;
-        DirectoryIterator it(dirPath);
-        DirectoryIterator end;
-        while (it != end) {
-            SplittedPath fileName = *it;
-            fileName.setSeparator(SplittedPath::unixSep());
-
-            readSources(fileName, parent);
-            ++it;
-        }
+        if (parent->isDirectory() &&
+            is_directory(parent->fullPath().jointOs().c_str()))
+            readDirectoryTree(parent);
         return;
     }
     FileNode *child =
         parent->findOrNewChild(splitted.front(), getFileType(fullpath));
     assert(child);
-    if (child->isRegularFile() && isSourceFile(fullpath))
+    if (child->isRegularFile() && isSourceFile(child->fname().str()))
         child->setSourceFile();
 
     SplittedPath nextRelPath = relPath;
@@ -83,20 +92,170 @@ void DirectoryReader::removeEmptyDirectories(FileTree &fileTree)
     fileTree.removeEmptyDirectories();
 }
 
-bool DirectoryReader::isSourceFile(const SplittedPath &sp) const
+bool DirectoryReader::isSourceFile(const std::string &fileName) const
+{
+    return _sourceExtensions.matches(fileName);
+}
+
+namespace {
+
+// per worker, the entries of most directories are read at once
+const size_t readBufferSize = 256 * 1024;
+
+#ifdef __linux__
+struct LinuxDirent64
+{
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+#endif
+
+// calls f(name, d_type) for the entries of the directory but . and ..,
+// d_type is DT_UNKNOWN if the file system doesn't tell
+template < typename TFunc >
+bool forEachEntry(const std::string &path, std::vector< char > &buffer,
+                  TFunc f)
+{
+#ifdef __linux__
+    // getdents64 fills the whole buffer, readdir() reads 32K at a time
+    const int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    for (;;) {
+        const long count =
+            syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+        if (count <= 0)
+            break;
+        for (long offset = 0; offset < count;) {
+            const LinuxDirent64 *entry =
+                reinterpret_cast< const LinuxDirent64 * >(buffer.data() +
+                                                          offset);
+            offset += entry->d_reclen;
+            const char *name = entry->d_name;
+            if (name[0] == '.' &&
+                (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+                continue;
+            f(name, entry->d_type);
+        }
+    }
+    close(fd);
+#else
+    (void)buffer;
+    DIR *dir = opendir(path.c_str());
+    if (!dir)
+        return false;
+    while (const struct dirent *entry = readdir(dir)) {
+        const char *name = entry->d_name;
+        if (name[0] == '.' &&
+            (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+            continue;
+#ifdef DT_UNKNOWN
+        f(name, entry->d_type);
+#else
+        f(name, 0);
+#endif
+    }
+    closedir(dir);
+#endif
+    return true;
+}
+
+} // namespace
+
+void DirectoryReader::readDirectoryTree(FileNode *directory)
+{
+    std::vector< std::vector< char > > buffers(
+        _jobs, std::vector< char >(readBufferSize));
+    std::vector< FileNode * > level(1, directory);
+    while (!level.empty()) {
+        // a worker changes only the nodes of the directories it reads
+        std::vector< std::vector< FileNode * > > subdirectories(level.size());
+        parallelFor(level.size(), _jobs,
+                    [this, &level, &buffers, &subdirectories](size_t i,
+                                                              unsigned worker) {
+                        readDirectory(level[i], buffers[worker],
+                                      subdirectories[i]);
+                    });
+
+        level.clear();
+        for (const auto &directories : subdirectories)
+            level.insert(level.end(), directories.begin(), directories.end());
+    }
+    // in the order of a sequential walk
+    labelSourceFiles(directory);
+}
+
+void DirectoryReader::readDirectory(
+    FileNode *directory, std::vector< char > &buffer,
+    std::vector< FileNode * > &subdirectories) const
+{
+    const SplittedPath dirPath = directory->fullPath();
+    const std::string osPath = dirPath.jointOs();
+    // the entry names are matched from the state the directory ends in
+    std::string unixPath = dirPath.jointUnix();
+    if (!unixPath.empty())
+        unixPath += '/';
+    const SubstringMatcher::State dirState =
+        _ignored.feed(_ignored.initial(), unixPath);
+    // children of a new directory are new, no need to look them up
+    const bool isNew = directory->childs().empty();
+
+    auto addEntry = [&](const char *name, unsigned char type) {
+        const size_t nameSize = strlen(name);
+        if (_ignored.isMatch(_ignored.feed(dirState, name, nameSize)))
+            return;
+
+        FileRecord::Type recordType;
+#ifdef DT_UNKNOWN
+        if (type == DT_DIR) {
+            recordType = FileRecord::Directory;
+        }
+        else if (type == DT_REG) {
+            recordType = FileRecord::RegularFile;
+        }
+        else
+#endif
+        {
+            // symbolic links are followed
+            (void)type;
+            const std::string entryPath = osPath + osSeparator() + name;
+            if (!exists(entryPath.c_str())) {
+                errors() << "warning: file " << unixPath + name
+                         << " doesn't exists";
+                return;
+            }
+            recordType = is_directory(entryPath.c_str())
+                             ? FileRecord::Directory
+                             : FileRecord::RegularFile;
+        }
+
+        const HashedFileName fname(std::string(name, nameSize));
+        FileNode *child = isNew ? directory->newChild(fname, recordType)
+                                : directory->findOrNewChild(fname, recordType);
+        if (child->isDirectory())
+            subdirectories.push_back(child);
+    };
+
+    if (!forEachEntry(osPath, buffer, addEntry))
+        std::cerr << "could not open directory " + osPath << std::endl;
+}
+
+void DirectoryReader::labelSourceFiles(FileNode *directory) const
 {
-    assert(is_file(sp.jointOs().c_str()));
-    std::string ext = extension(sp);
-    for (const auto &sourceFileExt : _sourceFileExtensions) {
-        if (sourceFileExt == ext)
-            return true;
+    for (FileNode *child : directory->childs()) {
+        if (child->isDirectory())
+            labelSourceFiles(child);
+        else if (isSourceFile(child->fname().str()))
+            child->setSourceFile();
     }
-    return false;
 }
 
 bool DirectoryReader::isIgnored(const SplittedPath &sp) const
 {
-    return checkPatterns(sp.jointUnix(), _ignore_substrings);
+    return _ignored.matches(sp.jointUnix());
 }
 
 bool DirectoryReader::isIgnoredOsSep(const std::string &path) const
@@ -1,6 +1,7 @@
 #ifndef DIRECTORY_READER_HPP
 #define DIRECTORY_READER_HPP
 
+#include "extensions/string_matchers.hpp"
 #include "types/file_tree.hpp"
 
 #include <iostream>
@@ -34,15 +35,26 @@ public:
     static StringVector _sourceFileExtensions;
     static StringVector _ignore_substrings;
 
+    DirectoryReader();
+
     void readSources(const SplittedPath &relPath, FileNode *parent);
     void readSources(const SplittedPath &relPath, FileTree &filetree);
 
     void setTestPatterns(const StringVector &patterns);
+    void setIgnoredSubstrings(const StringVector &substrings);
+    void setJobs(unsigned jobs) { _jobs = jobs; }
 
 private:
     void removeEmptyDirectories(FileTree &fileTree);
 
-    bool isSourceFile(const SplittedPath &sp) const; /// TODO use
+    // reads the whole tree under the directory a level at a time,
+    // the directories of a level are read in parallel
+    void readDirectoryTree(FileNode *directory);
+    void readDirectory(FileNode *directory, std::vector< char > &buffer,
+                       std::vector< FileNode * > &subdirectories) const;
+    void labelSourceFiles(FileNode *directory) const;
+
+    bool isSourceFile(const std::string &fileName) const;
     bool isIgnored(const SplittedPath &sp) const;
     bool isIgnoredOsSep(const std::string &path) const;
 
@@ -50,6 +62,11 @@ private:
 
 private:
     StringVector _testPatterns;
+    unsigned _jobs;
+
+    // compiled _ignore_substrings and _sourceFileExtensions
+    SubstringMatcher _ignored;
+    ExtensionMatcher _sourceExtensions;
 };
 
 #endif // DIRECTORY_READER_HPP
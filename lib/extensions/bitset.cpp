@@ -0,0 +1,63 @@
+#include "extensions/bitset.hpp"
+
+#include <algorithm>
+
+namespace {
+
+unsigned popCount(uint64_t word)
+{
+#ifdef _MSC_VER
+    return static_cast< unsigned >(__popcnt64(word));
+#else
+    return __builtin_popcountll(word);
+#endif
+}
+
+} // namespace
+
+void DynamicBitset::clear() { std::fill(_words.begin(), _words.end(), 0); }
+
+CompressedBitset::CompressedBitset(const DynamicBitset &bits)
+{
+    const std::vector< Word > &words = bits.words();
+
+    size_t count = 0;
+    size_t usedWords = 0;
+    for (size_t w = 0; w < words.size(); ++w) {
+        if (words[w]) {
+            count += popCount(words[w]);
+            usedWords = w + 1;
+        }
+    }
+
+    if (count * sizeof(Index) < usedWords * sizeof(Word)) {
+        _indices.reserve(count);
+        for (size_t w = 0; w < usedWords; ++w) {
+            for (Word word = words[w]; word; word &= word - 1)
+                _indices.push_back(static_cast< Index >(
+                    w * DynamicBitset::wordBits + countTrailingZeros(word)));
+        }
+    }
+    else {
+        _words.assign(words.begin(), words.begin() + usedWords);
+    }
+}
+
+bool CompressedBitset::test(Index i) const
+{
+    if (isDense()) {
+        const size_t w = i / DynamicBitset::wordBits;
+        return w < _words.size() &&
+               (_words[w] >> (i % DynamicBitset::wordBits) & 1);
+    }
+    return std::binary_search(_indices.begin(), _indices.end(), i);
+}
+
+void CompressedBitset::orInto(DynamicBitset &bits) const
+{
+    std::vector< Word > &words = bits.words();
+    for (size_t w = 0; w < _words.size(); ++w)
+        words[w] |= _words[w];
+    for (Index i : _indices)
+        bits.set(i);
+}
@@ -0,0 +1,86 @@
+#ifndef BITSET_HPP
+#define BITSET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Plain bitset of a size fixed at run time
+class DynamicBitset
+{
+public:
+    using Word = uint64_t;
+    static const unsigned wordBits = 64;
+
+    explicit DynamicBitset(size_t size = 0)
+        : _words((size + wordBits - 1) / wordBits)
+    {
+    }
+
+    void set(size_t i) { _words[i / wordBits] |= Word(1) << (i % wordBits); }
+    bool test(size_t i) const
+    {
+        return i / wordBits < _words.size() &&
+               (_words[i / wordBits] >> (i % wordBits) & 1);
+    }
+
+    void clear();
+
+    const std::vector< Word > &words() const { return _words; }
+    std::vector< Word > &words() { return _words; }
+
+private:
+    std::vector< Word > _words;
+};
+
+// Immutable set of indices, stored as a sorted array when it is sparse
+// and as a bitset when it is dense, whichever is smaller.
+class CompressedBitset
+{
+public:
+    using Index = uint32_t;
+    using Word = DynamicBitset::Word;
+
+    CompressedBitset() {}
+    explicit CompressedBitset(const DynamicBitset &bits);
+
+    bool empty() const { return _indices.empty() && _words.empty(); }
+    bool isDense() const { return !_words.empty(); }
+    bool test(Index i) const;
+
+    // word-wide when dense
+    void orInto(DynamicBitset &bits) const;
+
+    template < typename TFunc >
+    void forEach(TFunc f) const
+    {
+        for (Index i : _indices)
+            f(i);
+        for (size_t w = 0; w < _words.size(); ++w) {
+            for (Word word = _words[w]; word; word &= word - 1)
+                f(static_cast< Index >(w * DynamicBitset::wordBits +
+                                       countTrailingZeros(word)));
+        }
+    }
+
+private:
+    static unsigned countTrailingZeros(Word word)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward64(&index, word);
+        return index;
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
+
+    std::vector< Index > _indices;
+    std::vector< Word > _words;
+};
+
+#endif // BITSET_HPP
@@ -0,0 +1,83 @@
+#include "extensions/content_hasher.hpp"
+#include "extensions/help_functions.hpp"
+#include "extensions/md5.hpp"
+
+#include <cstring>
+
+namespace {
+
+class MD5Hasher : public ContentHasher
+{
+public:
+    Algorithm algorithm() const override { return MD5; }
+    void hash(const char *data, size_t size, HashArray &result) const override
+    {
+        ::MD5 md5(reinterpret_cast< const unsigned char * >(data),
+                  static_cast< ::MD5::size_type >(size));
+        md5.copyResultTo(result);
+    }
+};
+
+class Murmur3Hasher : public ContentHasher
+{
+public:
+    Algorithm algorithm() const override { return Murmur3; }
+    void hash(const char *data, size_t size, HashArray &result) const override
+    {
+        MurmurHash3_x64_128(data, size, 0, result);
+    }
+};
+
+struct AlgorithmName
+{
+    ContentHasher::Algorithm algorithm;
+    const char *name;
+};
+
+const AlgorithmName algorithmNames[] = {{ContentHasher::MD5, "md5"},
+                                        {ContentHasher::Murmur3, "murmur3"}};
+
+} // namespace
+
+const ContentHasher *ContentHasher::get(Algorithm algorithm)
+{
+    static const MD5Hasher md5Hasher;
+    static const Murmur3Hasher murmur3Hasher;
+
+    switch (algorithm) {
+    case MD5:
+        return &md5Hasher;
+    case Murmur3:
+        return &murmur3Hasher;
+    }
+    return nullptr;
+}
+
+bool ContentHasher::fromName(const std::string &name, Algorithm &algorithm)
+{
+    for (const auto &an : algorithmNames) {
+        if (name == an.name) {
+            algorithm = an.algorithm;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector< std::string > ContentHasher::names()
+{
+    std::vector< std::string > result;
+    for (const auto &an : algorithmNames)
+        result.push_back(an.name);
+    return result;
+}
+
+void copyHashArray(unsigned char *dest, const unsigned char *src)
+{
+    memcpy(dest, src, ContentHasher::hashSize);
+}
+
+bool compareHashArrays(const unsigned char *lhs, const unsigned char *rhs)
+{
+    return memcmp(lhs, rhs, ContentHasher::hashSize) == 0;
+}
@@ -0,0 +1,38 @@
+#ifndef CONTENT_HASHER_HPP
+#define CONTENT_HASHER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Hashes file contents to detect changes between runs,
+// the hash doesn't have to be cryptographic.
+class ContentHasher
+{
+public:
+    // stored in the file tree dump, don't renumber
+    enum Algorithm : uint8_t { MD5 = 0, Murmur3 = 1 };
+
+    static const size_t hashSize = 16;
+    typedef unsigned char HashArray[hashSize];
+
+    virtual ~ContentHasher() {}
+
+    virtual Algorithm algorithm() const = 0;
+    virtual void hash(const char *data, size_t size,
+                      HashArray &result) const = 0;
+
+    static const Algorithm defaultAlgorithm = Murmur3;
+
+    // returns nullptr for unknown algorithm
+    static const ContentHasher *get(Algorithm algorithm);
+
+    static bool fromName(const std::string &name, Algorithm &algorithm);
+    static std::vector< std::string > names();
+};
+
+void copyHashArray(unsigned char *dest, const unsigned char *src);
+bool compareHashArrays(const unsigned char *lhs, const unsigned char *rhs);
+
+#endif // CONTENT_HASHER_HPP
@@ -1,7 +1,19 @@
 #include "extensions/error_reporter.hpp"
 
+#include <mutex>
+
+static std::mutex &errorsMutex()
+{
+    static std::mutex m;
+    return m;
+}
+
 ErrorStream errors() { return ErrorStream(); }
 
-ErrorStream::NewlinePrinter::~NewlinePrinter() { std::cerr << std::endl; }
+ErrorStream::NewlinePrinter::~NewlinePrinter()
+{
+    std::lock_guard< std::mutex > lock(errorsMutex());
+    std::cerr << message.str() << std::endl;
+}
 
 ErrorStream::ErrorStream() : _nlprntr(new NewlinePrinter()) {}
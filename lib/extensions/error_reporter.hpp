@@ -3,20 +3,27 @@
 
 #include <iostream>
 #include <memory>
+#include <sstream>
 #include <utility> // std::forward
 
 class ErrorStream
 {
+    // collects the whole message and prints it at once,
+    // so messages from different threads don't interleave
     class NewlinePrinter
     {
     public:
         ~NewlinePrinter();
+
+        std::ostringstream message;
     };
 
     std::unique_ptr< NewlinePrinter > _nlprntr;
 
 public:
     ErrorStream();
+
+    std::ostream &stream() { return _nlprntr->message; }
 };
 
 ErrorStream errors();
@@ -24,7 +31,7 @@ ErrorStream errors();
 template < typename T >
 ErrorStream operator<<(ErrorStream stream, T &&var)
 {
-    std::cerr << std::forward< T >(var) << ' ';
+    stream.stream() << std::forward< T >(var) << ' ';
     return stream;
 }
 
@@ -1,4 +1,5 @@
 #include "extensions/flatbuffers_extensions.hpp"
+#include "dependency_analyzer.hpp"
 
 template < typename FT, typename T >
 void FileTreeFunc::copyVector(const FT &flatVector, T &v)
@@ -33,38 +34,178 @@ template void
 FileTreeFunc::copyListSplitted< SetScopedName >(const LazyUT::ListSplitted &fv,
                                                 SetScopedName &v);
 
-void FileTreeFunc::deserialize(FileTree &tree, const SplittedPath &sp)
-{
-    auto fileData = readBinaryFile(sp.jointOs().c_str());
-    char *file_tree_dump = fileData.data.get();
-    if (file_tree_dump) {
-        auto file_tree = LazyUT::GetFileTree(file_tree_dump);
-
-        SplittedPath spRootPath(file_tree->rootPath()->str(),
-                                SplittedPath::unixSep());
-        tree.setRootPath(spRootPath);
-        auto &records = *file_tree->records();
-        for (const auto &record : records) {
-            SplittedPath sp(record->path()->str(), SplittedPath::unixSep());
-            FileNode *fnode = tree.addFile(sp);
-            FileRecord &fileRecord = fnode->record();
-
-            fileRecord.setHash(record->md5()->data()); // Hash
-            copyVector(*record->includes(), fileRecord._listIncludes);
-            copyListSplitted(*record->implements(), fileRecord._setImplements);
-            copyListSplitted(*record->inheritances(),
-                             fileRecord._setInheritances);
-            copyListSplitted(*record->class_decls(), fileRecord._setClassDecl);
-            copyListSplitted(*record->function_decls(),
-                             fileRecord._setFuncDecl);
-            copyListSplitted(*record->using_namespaces(),
-                             fileRecord._listUsingNamespace);
-
-            /// TODO install separators
-        }
-
-        tree.setState(FileTree::Restored);
+bool FileTreeSnapshot::load(const FileData &data)
+{
+    _fileTree = nullptr;
+    _data = data;
+    if (!_data.data || _data.size < sizeof(flatbuffers::uoffset_t))
+        return false;
+
+    auto fileTree = LazyUT::GetFileTree(_data.data.get());
+    if (fileTree->version() != version || !fileTree->records()) {
+        // dumps of other versions have unsorted records, don't use them
+        _data = FileData();
+        return false;
+    }
+    _fileTree = fileTree;
+    return true;
+}
+
+ContentHasher::Algorithm FileTreeSnapshot::hashAlgorithm() const
+{
+    assert(_fileTree);
+    return static_cast< ContentHasher::Algorithm >(_fileTree->hash_algorithm());
+}
+
+const LazyUT::FileRecord *FileTreeSnapshot::find(const std::string &path) const
+{
+    assert(_fileTree);
+    return _fileTree->records()->LookupByKey(path.c_str());
+}
+
+const flatbuffers::Vector< flatbuffers::Offset< LazyUT::FileRecord > > &
+FileTreeSnapshot::records() const
+{
+    assert(_fileTree);
+    return *_fileTree->records();
+}
+
+uint32_t FileTreeSnapshot::nextFileId() const
+{
+    assert(_fileTree);
+    return _fileTree->next_file_id();
+}
+
+std::vector< std::string > FileTreeSnapshot::includePaths() const
+{
+    assert(_fileTree);
+    std::vector< std::string > result;
+    if (_fileTree->include_paths())
+        FileTreeFunc::copyVector(*_fileTree->include_paths(), result);
+    return result;
+}
+
+const flatbuffers::Vector< flatbuffers::Offset< LazyUT::Declaration > > *
+FileTreeSnapshot::classDeclarations() const
+{
+    assert(_fileTree);
+    return _fileTree->class_decls();
+}
+
+const flatbuffers::Vector< flatbuffers::Offset< LazyUT::Declaration > > *
+FileTreeSnapshot::functionDeclarations() const
+{
+    assert(_fileTree);
+    return _fileTree->function_decls();
+}
+
+void FileTreeSnapshot::restoreParsedData(const LazyUT::FileRecord &record,
+                                         FileRecord &fileRecord)
+{
+    FileTreeFunc::copyVector(*record.includes(), fileRecord._listIncludes);
+    FileTreeFunc::copyListSplitted(*record.implements(),
+                                   fileRecord._setImplements);
+    FileTreeFunc::copyListSplitted(*record.inheritances(),
+                                   fileRecord._setInheritances);
+    FileTreeFunc::copyListSplitted(*record.class_decls(),
+                                   fileRecord._setClassDecl);
+    FileTreeFunc::copyListSplitted(*record.function_decls(),
+                                   fileRecord._setFuncDecl);
+    FileTreeFunc::copyListSplitted(*record.using_namespaces(),
+                                   fileRecord._listUsingNamespace);
+
+    /// TODO install separators
+}
+
+static size_t countNames(const LazyUT::ListSplitted *names)
+{
+    return names && names->splitted_paths() ? names->splitted_paths()->size()
+                                             : 0;
+}
+
+static bool sameNames(const LazyUT::ListSplitted *names,
+                      const std::unordered_set< ScopedName > &set)
+{
+    if (countNames(names) != set.size())
+        return false;
+    if (set.empty())
+        return true;
+
+    const std::string sep = names->separator()->str();
+    for (const flatbuffers::String *name : *names->splitted_paths()) {
+        if (set.find(ScopedName(name->str(), sep)) == set.end())
+            return false;
     }
+    return true;
+}
+
+bool FileTreeSnapshot::hasDeclarations(const LazyUT::FileRecord &record)
+{
+    return countNames(record.class_decls()) ||
+           countNames(record.function_decls());
+}
+
+bool FileTreeSnapshot::sameDeclarations(const LazyUT::FileRecord &record,
+                                        const FileRecord &fileRecord)
+{
+    return sameNames(record.class_decls(), fileRecord._setClassDecl) &&
+           sameNames(record.function_decls(), fileRecord._setFuncDecl);
+}
+
+template < typename TFunc >
+static bool forEachFile(const flatbuffers::Vector< uint32_t > *ids,
+                        const FileTree::FileIdMap &files, TFunc f)
+{
+    if (!ids)
+        return true;
+    for (uint32_t id : *ids) {
+        auto it = files.find(id);
+        if (it == files.end())
+            return false;
+        f(it->second);
+    }
+    return true;
+}
+
+bool FileTreeSnapshot::restoreIncludedFiles(
+    const LazyUT::FileRecord &record, const FileTree::FileIdMap &files,
+    FileNode::ListFileNode &includedFiles)
+{
+    bool restored =
+        forEachFile(record.include_files(), files, [&](FileNode *file) {
+            includedFiles.push_back(file);
+        });
+    if (!restored)
+        includedFiles.clear();
+    return restored;
+}
+
+bool FileTreeSnapshot::restoreAnalyzedData(const LazyUT::FileRecord &record,
+                                           const FileTree::FileIdMap &files,
+                                           FileRecord &fileRecord)
+{
+    bool restored =
+        forEachFile(record.base_class_files(), files,
+                    [&](FileNode *file) {
+                        fileRecord._setBaseClassFiles.insert(file->path());
+                    }) &&
+        forEachFile(record.func_impl_files(), files,
+                    [&](FileNode *file) {
+                        fileRecord._setImplementFiles.insert(file->path());
+                        fileRecord._setFuncImplFiles.insert(file->path());
+                    }) &&
+        forEachFile(record.class_impl_files(), files, [&](FileNode *file) {
+            fileRecord._setImplementFiles.insert(file->path());
+            fileRecord._setClassImplFiles.insert(file->path());
+        });
+    if (!restored) {
+        // analyzed again
+        fileRecord._setBaseClassFiles.clear();
+        fileRecord._setImplementFiles.clear();
+        fileRecord._setFuncImplFiles.clear();
+        fileRecord._setClassImplFiles.clear();
+    }
+    return restored;
 }
 
 static flatbuffers::Offset<
@@ -105,13 +246,56 @@ CreateVectorOfStrings(flatbuffers::FlatBufferBuilder &builder,
     return builder.CreateVector(offsets);
 }
 
+static flatbuffers::Offset< flatbuffers::Vector< uint32_t > >
+CreateVectorOfIds(flatbuffers::FlatBufferBuilder &builder,
+                  const FileNode::ListFileNode &files)
+{
+    std::vector< uint32_t > ids;
+    ids.reserve(files.size());
+    for (const FileNode *file : files)
+        ids.push_back(file->record()._id);
+    return builder.CreateVector(ids);
+}
+
+static flatbuffers::Offset< flatbuffers::Vector< uint32_t > >
+CreateVectorOfIds(flatbuffers::FlatBufferBuilder &builder,
+                  const FileTree &tree,
+                  const std::unordered_set< ScopedName > &paths)
+{
+    std::vector< uint32_t > ids;
+    ids.reserve(paths.size());
+    for (const ScopedName &path : paths) {
+        if (const FileNode *file = tree.searchInRoot(path))
+            ids.push_back(file->record()._id);
+    }
+    return builder.CreateVector(ids);
+}
+
+static flatbuffers::Offset<
+    flatbuffers::Vector< flatbuffers::Offset< LazyUT::Declaration > > >
+CreateVectorOfDeclarations(flatbuffers::FlatBufferBuilder &builder,
+                           const DeclarationIndex *index)
+{
+    if (!index)
+        return 0; // not analyzed, the next run builds it
+
+    std::vector< flatbuffers::Offset< LazyUT::Declaration > > decls;
+    index->forEach([&](const std::string &name,
+                       const std::vector< uint32_t > &ids) {
+        decls.push_back(LazyUT::CreateDeclaration(
+            builder, builder.CreateString(name), builder.CreateVector(ids)));
+    });
+    // sorted already
+    return builder.CreateVector(decls);
+}
+
 static void
 pushFiles(flatbuffers::FlatBufferBuilder &builder,
           std::vector< flatbuffers::Offset< LazyUT::FileRecord > > &records,
-          const FileNode *node)
+          const FileTree &tree, const FileNode *node)
 {
     if (node->isRegularFile()) {
-        auto frecord = node->record();
+        const FileRecord &frecord = node->record();
         auto fbs_frecord = LazyUT::CreateFileRecord(
             builder, builder.CreateString(frecord._path.joint()),
             builder.CreateVector(frecord._hashArray, 16),
@@ -125,20 +309,37 @@ pushFiles(flatbuffers::FlatBufferBuilder &builder,
             CreateListSplittedH(builder, frecord._setFuncDecl,
                                 SplittedPath::namespaceSep()),
             CreateListSplittedH(builder, frecord._listUsingNamespace,
-                                SplittedPath::namespaceSep()));
+                                SplittedPath::namespaceSep()),
+            frecord._stat.mtimeNs, frecord._stat.size, frecord._stat.inode,
+            frecord._id, CreateVectorOfIds(builder, node->_includedFiles),
+            CreateVectorOfIds(builder, tree, frecord._setBaseClassFiles),
+            CreateVectorOfIds(builder, tree, frecord._setFuncImplFiles),
+            CreateVectorOfIds(builder, tree, frecord._setClassImplFiles));
         records.push_back(fbs_frecord);
     }
 
     const FileNode::ListFileNode &childs = node->childs();
     FileNode::FileNodeConstIterator it(childs.cbegin());
     while (it != childs.cend()) {
-        pushFiles(builder, records, *it);
+        pushFiles(builder, records, tree, *it);
 
         ++it;
     }
 }
 
 void FileTreeFunc::serialize(const FileTree &tree, const SplittedPath &sp)
+{
+    const FileData dump = serialize(tree);
+
+    // the next run maps the dump, so it's replaced at once, never rewritten
+    const std::string fname = sp.jointOs();
+    const std::string tmpName = fname + ".tmp";
+    if (writeBinaryFile(tmpName.c_str(), dump.data.get(), sizeof(char),
+                        dump.size))
+        rename_file(tmpName.c_str(), fname.c_str());
+}
+
+FileData FileTreeFunc::serialize(const FileTree &tree)
 {
     assert(tree.rootNode());
 
@@ -146,15 +347,29 @@ void FileTreeFunc::serialize(const FileTree &tree, const SplittedPath &sp)
     flatbuffers::FlatBufferBuilder builder(1024);
 
     std::vector< flatbuffers::Offset< LazyUT::FileRecord > > fileRecords;
-    pushFiles(builder, fileRecords, tree.rootNode());
+    pushFiles(builder, fileRecords, tree, tree.rootNode());
 
+    std::vector< std::string > includePaths;
+    for (const FileNode *includePath : tree.includePaths())
+        includePaths.push_back(includePath->name());
+
+    // sorted records are looked up by path in the next run
     auto fbs_file_tree = LazyUT::CreateFileTree(
         builder, builder.CreateString(tree.rootPath().joint()),
-        builder.CreateVector(fileRecords));
+        builder.CreateVectorOfSortedTables(&fileRecords), tree.hashAlgorithm(),
+        FileTreeSnapshot::version, tree.nextFileId(),
+        builder.CreateVectorOfStrings(includePaths),
+        CreateVectorOfDeclarations(builder, tree.classDeclarations()),
+        CreateVectorOfDeclarations(builder, tree.functionDeclarations()));
 
     builder.Finish(fbs_file_tree);
-    uint8_t *data = builder.GetBufferPointer();
-    assert(data != nullptr);
-    writeBinaryFile(sp.jointOs().c_str(), data, sizeof(*data),
-                    builder.GetSize());
+
+    // taken from the builder without a copy
+    size_t size, offset;
+    std::shared_ptr< uint8_t > buffer(builder.ReleaseRaw(size, offset),
+                                      std::default_delete< uint8_t[] >());
+    assert(buffer);
+    return FileData(std::shared_ptr< char >(buffer, reinterpret_cast< char * >(
+                                                        buffer.get() + offset)),
+                    size - offset);
 }
@@ -5,10 +5,57 @@
 #include "flatbuffers_schemes/file_tree_generated.h"
 #include "types/file_tree.hpp"
 
+// File tree dump of the previous run. The dump is mapped into memory and
+// read in place: records are looked up by path, and parsed data is
+// restored only for the files which need it.
+class FileTreeSnapshot
+{
+public:
+    // dumps with another version are ignored
+    static const uint32_t version = 3;
+
+    FileTreeSnapshot() : _fileTree(nullptr) {}
+
+    bool load(const FileData &data);
+
+    ContentHasher::Algorithm hashAlgorithm() const;
+    const LazyUT::FileRecord *find(const std::string &path) const;
+
+    const flatbuffers::Vector< flatbuffers::Offset< LazyUT::FileRecord > > &
+    records() const;
+    uint32_t nextFileId() const;
+    std::vector< std::string > includePaths() const;
+    // sorted by name
+    const flatbuffers::Vector< flatbuffers::Offset< LazyUT::Declaration > > *
+    classDeclarations() const;
+    const flatbuffers::Vector< flatbuffers::Offset< LazyUT::Declaration > > *
+    functionDeclarations() const;
+
+    static void restoreParsedData(const LazyUT::FileRecord &record,
+                                  FileRecord &fileRecord);
+
+    static bool hasDeclarations(const LazyUT::FileRecord &record);
+    static bool sameDeclarations(const LazyUT::FileRecord &record,
+                                 const FileRecord &fileRecord);
+
+    // explicit dependencies resolved in the previous run,
+    // fail if some of the files is missing
+    static bool restoreIncludedFiles(const LazyUT::FileRecord &record,
+                                     const FileTree::FileIdMap &files,
+                                     FileNode::ListFileNode &includedFiles);
+    static bool restoreAnalyzedData(const LazyUT::FileRecord &record,
+                                    const FileTree::FileIdMap &files,
+                                    FileRecord &fileRecord);
+
+private:
+    FileData _data;
+    const LazyUT::FileTree *_fileTree;
+};
+
 namespace FileTreeFunc {
 
-void deserialize(FileTree &tree, const SplittedPath &sp);
 void serialize(const FileTree &tree, const SplittedPath &fileName);
+FileData serialize(const FileTree &tree);
 
 template < typename FT, typename T >
 void copyVector(const FT &flatVector, T &v);
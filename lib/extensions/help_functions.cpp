@@ -6,6 +6,7 @@
 #include <fstream>
 #include <memory>
 #include <algorithm> // any_of
+#include <chrono>
 
 #include <stdio.h>
 #include <string.h>
@@ -19,11 +20,15 @@
 #define access _access_s // access
 #else                    // POSIX
 #include <sys/stat.h>    // file_size, mkdir
-#include <unistd.h>      // access
+#include <unistd.h>      // access, pread
+#include <fcntl.h>       // open
+#include <sys/mman.h>    // mmap
+#include <cerrno>
 #endif
 
 FileData readBinaryFile(const char *fname) { return readFile(fname, "rb"); }
 
+#ifdef WIN32
 FileData readFile(const char *fname, const char *mode)
 {
     if (!exists(fname)) {
@@ -38,13 +43,84 @@ FileData readFile(const char *fname, const char *mode)
         return FileData();
     }
     long long fsize = file_size(fname);
-    std::shared_ptr< char > data(new char[fsize + 1]);
+    std::shared_ptr< char > data(new char[fsize + 1],
+                                 std::default_delete< char[] >());
     size_t read_count = fread(data.get(), sizeof(char), fsize, file);
     fclose(file);
+    data.get()[read_count] = '\0';
+
+    return FileData(data, read_count);
+}
+#else // POSIX
+// Smaller files are read with pread(), mapping them costs more than copying
+static const size_t mmapThreshold = 64 * 1024;
+
+static FileData mapFile(int fd, size_t size)
+{
+    // the tokenizer may look one byte past the end, so only files which
+    // don't fill their last page are mapped: the rest of it reads as zeros
+    static const size_t pageSize = static_cast< size_t >(sysconf(_SC_PAGESIZE));
+    if (size < mmapThreshold || size % pageSize == 0)
+        return FileData();
+
+    void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr == MAP_FAILED)
+        return FileData();
+    madvise(addr, size, MADV_SEQUENTIAL);
+
+    std::shared_ptr< char > data(static_cast< char * >(addr),
+                                 [size](char *p) { munmap(p, size); });
+    return FileData(data, size);
+}
+
+static FileData preadFile(int fd, size_t size)
+{
+    std::shared_ptr< char > data(new char[size + 1],
+                                 std::default_delete< char[] >());
+    size_t read_count = 0;
+    while (read_count < size) {
+        ssize_t n = pread(fd, data.get() + read_count, size - read_count,
+                          static_cast< off_t >(read_count));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        read_count += static_cast< size_t >(n);
+    }
+    data.get()[read_count] = '\0';
 
     return FileData(data, read_count);
 }
 
+FileData readFile(const char *fname, const char * /*mode*/)
+{
+    int fd = open(fname, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (clargs.verbal()) {
+            if (errno == ENOENT)
+                errors() << "file" << std::string(fname) << "doesn't exist";
+            else
+                errors() << "file" << std::string(fname)
+                         << "can not be opened";
+        }
+        return FileData();
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return FileData();
+    }
+
+    const size_t size = static_cast< size_t >(st.st_size);
+    FileData result = mapFile(fd, size);
+    if (!result.data)
+        result = preadFile(fd, size);
+    close(fd);
+
+    return result;
+}
+#endif
+
 std::vector< char > strToVChar(const std::string &str)
 {
     std::vector< char > result;
@@ -108,6 +184,40 @@ long long file_size(const char *fname)
 #endif
 }
 
+bool file_stat(const char *fname, FileStat &st)
+{
+#ifdef WIN32
+    struct _stat64 statbuf;
+    if (_stat64(fname, &statbuf) == -1)
+        return false;
+    st.mtimeNs = static_cast< uint64_t >(statbuf.st_mtime) * 1000000000ull;
+    st.size = statbuf.st_size;
+    st.inode = 0; // not meaningful on Windows
+#else // POSIX
+    struct stat statbuf;
+    if (stat(fname, &statbuf) == -1)
+        return false;
+#ifdef __APPLE__
+    const struct timespec &mtime = statbuf.st_mtimespec;
+#else
+    const struct timespec &mtime = statbuf.st_mtim;
+#endif
+    st.mtimeNs = static_cast< uint64_t >(mtime.tv_sec) * 1000000000ull +
+                 static_cast< uint64_t >(mtime.tv_nsec);
+    st.size = statbuf.st_size;
+    st.inode = statbuf.st_ino;
+#endif
+    return true;
+}
+
+uint64_t current_time_ns()
+{
+    using namespace std::chrono;
+    return duration_cast< nanoseconds >(
+               system_clock::now().time_since_epoch())
+        .count();
+}
+
 std::string makeIndents(int indent, int extra_spaces)
 {
     std::string strIndents;
@@ -145,24 +255,41 @@ char osSeparator()
 #endif
 }
 
-void writeBinaryFile(const char *fname, const void *data, size_t type_size,
+bool writeBinaryFile(const char *fname, const void *data, size_t type_size,
                      size_t length)
 {
     FILE *pFile = fopen(fname, "wb");
     if (!pFile) {
         errors() << "ERROR: Write:: Failed to open file" << std::string(fname);
-        return;
+        return false;
     }
 
-    fwrite(data, type_size, length, pFile);
-    fclose(pFile);
+    bool written = (fwrite(data, type_size, length, pFile) == length);
+    if (fclose(pFile) != 0)
+        written = false;
+    if (!written)
+        errors() << "ERROR: Write:: Failed to write file" << std::string(fname);
+    return written;
+}
+
+bool rename_file(const char *from, const char *to)
+{
+#ifdef WIN32
+    bool renamed = MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING);
+#else
+    bool renamed = (rename(from, to) == 0);
+#endif
+    if (!renamed)
+        errors() << "ERROR: Failed to rename" << std::string(from) << "to"
+                 << std::string(to);
+    return renamed;
 }
 
 bool checkPatterns(const std::string &str,
                    const std::vector< std::string > &patterns)
 {
     return std::any_of(patterns.begin(), patterns.end(),
-                       [str](const std::string &pattern) {
+                       [&str](const std::string &pattern) {
                            return str_contains(str, pattern);
                        });
 }
@@ -170,8 +297,7 @@ bool checkPatterns(const std::string &str,
 bool is_directory(const char *path)
 {
     struct stat buf;
-    stat(path, &buf);
-    return S_ISDIR(buf.st_mode);
+    return stat(path, &buf) == 0 && S_ISDIR(buf.st_mode);
 }
 
 bool is_directory(const SplittedPath &sp)
@@ -182,8 +308,7 @@ bool is_directory(const SplittedPath &sp)
 bool is_file(const char *path)
 {
     struct stat buf;
-    stat(path, &buf);
-    return S_ISREG(buf.st_mode);
+    return stat(path, &buf) == 0 && S_ISREG(buf.st_mode);
 }
 
 bool is_file(const SplittedPath &sp) { return is_file(sp.jointOs().c_str()); }
@@ -8,6 +8,8 @@
 #include <sstream>
 #include <vector>
 #include <cassert>
+#include <cstdint>
+#include <memory>
 
 #define MY_PRINTEXT(x)                                                         \
     std::cout << #x << " EXT_FILE : " << _currentFile->name()                  \
@@ -49,10 +51,15 @@ inline bool str_equal(const std::string &str, const std::string &substr)
 
 using MurmurHashType = unsigned int;
 MurmurHashType MurmurHash2(const void *key, int len, unsigned int seed = 0);
+// writes 16 bytes to out
+void MurmurHash3_x64_128(const void *key, size_t len, uint32_t seed,
+                         unsigned char *out);
 
 double getWallTime();
 double getCpuTime();
 
+// Contents of a file: mapped for big files, read into memory otherwise.
+// data is followed by a zero byte in both cases.
 struct FileData
 {
     std::shared_ptr< char > data;
@@ -62,6 +69,25 @@ struct FileData
     FileData() : size(0) {}
 };
 
+// The part of stat() which tells whether a file was touched
+struct FileStat
+{
+    uint64_t mtimeNs;
+    uint64_t size;
+    uint64_t inode;
+
+    FileStat() : mtimeNs(0), size(0), inode(0) {}
+
+    bool isKnown() const { return mtimeNs != 0; }
+    void clear() { *this = FileStat(); }
+
+    bool operator==(const FileStat &o) const
+    {
+        return mtimeNs == o.mtimeNs && size == o.size && inode == o.inode;
+    }
+    bool operator!=(const FileStat &o) const { return !(*this == o); }
+};
+
 char osSeparator();
 inline bool is_separator(char ch) { return ch == '/' || ch == '\\'; }
 bool exists(const char *path);
@@ -70,6 +96,8 @@ bool is_directory(const char *path);
 std::string extension(const std::string &filename);
 void create_directory(const std::string &path);
 void create_directories(const std::string &path);
+// replaces `to` if it exists
+bool rename_file(const char *from, const char *to);
 
 bool exists(const SplittedPath &sp);
 bool is_file(const SplittedPath &sp);
@@ -79,11 +107,13 @@ void create_directory(const SplittedPath &sp);
 void create_directories(const SplittedPath &sp);
 
 long long file_size(const char *fname);
+bool file_stat(const char *fname, FileStat &st);
+uint64_t current_time_ns();
 
 FileData readBinaryFile(const char *fname);
 FileData readFile(const char *fname, const char *mode);
 
-void writeBinaryFile(const char *fname, const void *data, size_t type_size,
+bool writeBinaryFile(const char *fname, const void *data, size_t type_size,
                      size_t length);
 
 class Profiler
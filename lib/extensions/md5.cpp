@@ -386,20 +386,3 @@ std::string md5(const std::string str)
 
     return md5.hexdigest();
 }
-
-void copyHashArray(unsigned char *dest, const unsigned char *src)
-{
-    for (size_t i = 0; i < (sizeof(MD5::HashArray) / sizeof(unsigned char));
-         ++i)
-        dest[i] = src[i];
-}
-
-bool compareHashArrays(const unsigned char *lhs, const unsigned char *rhs)
-{
-    for (size_t i = 0; i < (sizeof(MD5::HashArray) / sizeof(MD5::uint1)); ++i) {
-        if (lhs[i] != rhs[i])
-            return false;
-    }
-    // every byte is the same
-    return true;
-}
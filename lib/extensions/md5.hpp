@@ -98,7 +98,4 @@ private:
 
 std::string md5(const std::string str);
 
-void copyHashArray(unsigned char *dest, const unsigned char *src);
-bool compareHashArrays(const unsigned char *lhs, const unsigned char *rhs);
-
 #endif
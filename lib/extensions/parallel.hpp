@@ -0,0 +1,52 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+inline unsigned hardwareJobs()
+{
+    unsigned jobs = std::thread::hardware_concurrency();
+    return jobs > 0 ? jobs : 1;
+}
+
+// Calls f(index, worker) for every index in [0, count) using up to `jobs`
+// threads. Workers take indices from a shared counter in small chunks, so a
+// worker that runs out of work keeps taking over the rest of the range while
+// the others are busy with slow items. `worker` is in [0, jobs) and may be
+// used to address per-thread state.
+template < typename TFunc >
+void parallelFor(size_t count, unsigned jobs, TFunc f)
+{
+    static const size_t chunkSize = 16;
+
+    jobs = static_cast< unsigned >(
+        std::min< size_t >(jobs, (count + chunkSize - 1) / chunkSize));
+    if (jobs <= 1) {
+        for (size_t i = 0; i < count; ++i)
+            f(i, 0u);
+        return;
+    }
+
+    std::atomic< size_t > next(0);
+    auto work = [&next, count, &f](unsigned worker) {
+        size_t begin;
+        while ((begin = next.fetch_add(chunkSize)) < count) {
+            size_t end = std::min(begin + chunkSize, count);
+            for (size_t i = begin; i < end; ++i)
+                f(i, worker);
+        }
+    };
+
+    std::vector< std::thread > threads;
+    threads.reserve(jobs - 1);
+    for (unsigned worker = 1; worker < jobs; ++worker)
+        threads.emplace_back(work, worker);
+    work(0);
+    for (auto &thread : threads)
+        thread.join();
+}
+
+#endif // PARALLEL_HPP
@@ -0,0 +1,151 @@
+#include "extensions/string_matchers.hpp"
+#include "extensions/help_functions.hpp"
+
+#include <cstring>
+
+namespace {
+
+const uint32_t noNode = UINT32_MAX;
+
+} // namespace
+
+SubstringMatcher::SubstringMatcher()
+    : _classCount(1), _next(1, 0), _initial(0), _matched(1)
+{
+    memset(_classes, 0, sizeof(_classes));
+}
+
+SubstringMatcher::SubstringMatcher(const std::vector< std::string > &substrings)
+{
+    // class 0 is for the bytes in none of the substrings
+    memset(_classes, 0, sizeof(_classes));
+    _classCount = 1;
+    for (const std::string &substring : substrings) {
+        for (char ch : substring) {
+            unsigned char &cls = _classes[static_cast< unsigned char >(ch)];
+            if (!cls)
+                cls = static_cast< unsigned char >(_classCount++);
+        }
+    }
+
+    // trie of the substrings, noNode for missing edges
+    std::vector< State > next(_classCount, noNode);
+    std::vector< bool > isEnd(1, false);
+    for (const std::string &substring : substrings) {
+        State state = 0;
+        for (char ch : substring) {
+            const unsigned cls = _classes[static_cast< unsigned char >(ch)];
+            const size_t edge = state * _classCount + cls;
+            if (next[edge] == noNode) {
+                next[edge] = static_cast< State >(isEnd.size());
+                isEnd.push_back(false);
+                next.resize(next.size() + _classCount, noNode);
+            }
+            state = next[edge];
+        }
+        isEnd[state] = true;
+    }
+    const State count = static_cast< State >(isEnd.size());
+
+    // breadth first, the failure state of a state is shallower, so its
+    // transitions are complete when the state is reached
+    std::vector< State > fail(count, 0);
+    std::vector< State > queue;
+    for (unsigned cls = 0; cls < _classCount; ++cls) {
+        State &edge = next[cls];
+        if (edge == noNode)
+            edge = 0;
+        else
+            queue.push_back(edge);
+    }
+    for (size_t i = 0; i < queue.size(); ++i) {
+        const State state = queue[i];
+        if (isEnd[fail[state]])
+            isEnd[state] = true;
+        for (unsigned cls = 0; cls < _classCount; ++cls) {
+            State &edge = next[state * _classCount + cls];
+            const State fallback = next[fail[state] * _classCount + cls];
+            if (edge == noNode) {
+                edge = fallback;
+            }
+            else {
+                fail[edge] = fallback;
+                queue.push_back(edge);
+            }
+        }
+    }
+
+    // a match is final: the states where a substring ends lead to the
+    // matched state, which is appended and never left
+    _matched = count;
+    _next.resize((count + 1) * _classCount);
+    for (State state = 0; state < count; ++state) {
+        for (unsigned cls = 0; cls < _classCount; ++cls) {
+            const State target = next[state * _classCount + cls];
+            _next[state * _classCount + cls] =
+                isEnd[target] ? _matched : target;
+        }
+    }
+    for (unsigned cls = 0; cls < _classCount; ++cls)
+        _next[_matched * _classCount + cls] = _matched;
+    // an empty substring is contained in every string
+    _initial = isEnd[0] ? _matched : 0;
+}
+
+ExtensionMatcher::ExtensionMatcher()
+    : _nodes(1, Node{noNode, noNode, '\0', false}), _matchesNone(false)
+{
+}
+
+ExtensionMatcher::ExtensionMatcher(const std::vector< std::string > &extensions)
+    : ExtensionMatcher()
+{
+    for (const std::string &extension : extensions) {
+        if (extension.empty())
+            _matchesNone = true;
+
+        uint32_t node = 0;
+        for (auto it = extension.rbegin(); it != extension.rend(); ++it) {
+            uint32_t found = child(node, *it);
+            if (found == noNode) {
+                found = static_cast< uint32_t >(_nodes.size());
+                _nodes.push_back(
+                    Node{noNode, _nodes[node].firstChild, *it, false});
+                _nodes[node].firstChild = found;
+            }
+            node = found;
+        }
+        _nodes[node].isEnd = true;
+    }
+}
+
+uint32_t ExtensionMatcher::child(uint32_t node, char ch) const
+{
+    for (uint32_t c = _nodes[node].firstChild; c != noNode;
+         c = _nodes[c].nextSibling) {
+        if (_nodes[c].ch == ch)
+            return c;
+    }
+    return noNode;
+}
+
+bool ExtensionMatcher::matches(const char *name, size_t size) const
+{
+    uint32_t node = 0;
+    size_t i = size;
+    while (i > 0) {
+        const char ch = name[--i];
+        if (is_separator(ch))
+            break; // the last part has no dot
+        if (node != noNode)
+            node = child(node, ch);
+        if (ch != '.')
+            continue;
+
+        // names starting with a dot have no extension
+        if (i == 0 || is_separator(name[i - 1]))
+            break;
+        return node != noNode && _nodes[node].isEnd;
+    }
+    return _matchesNone;
+}
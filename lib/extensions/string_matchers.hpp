@@ -0,0 +1,89 @@
+#ifndef STRING_MATCHERS_HPP
+#define STRING_MATCHERS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Whether a string contains any of the substrings, in one pass over the
+// string (Aho-Corasick). The failure links are folded into a transition
+// table over the byte classes of the substrings, and every state where
+// some substring ends leads to the one matched state, so a byte costs one
+// lookup. Strings may be fed in parts, e.g. a directory path once and then
+// the names of its entries from the state it ends in.
+class SubstringMatcher
+{
+public:
+    using State = uint32_t;
+
+    // matches nothing
+    SubstringMatcher();
+    explicit SubstringMatcher(const std::vector< std::string > &substrings);
+
+    State initial() const { return _initial; }
+    State feed(State state, const char *data, size_t size) const
+    {
+        for (size_t i = 0; i < size && state != _matched; ++i)
+            state = _next[state * _classCount +
+                          _classes[static_cast< unsigned char >(data[i])]];
+        return state;
+    }
+    State feed(State state, const std::string &str) const
+    {
+        return feed(state, str.data(), str.size());
+    }
+    bool isMatch(State state) const { return state == _matched; }
+
+    bool matches(const char *data, size_t size) const
+    {
+        return isMatch(feed(_initial, data, size));
+    }
+    bool matches(const std::string &str) const
+    {
+        return matches(str.data(), str.size());
+    }
+
+private:
+    unsigned char _classes[256];
+    unsigned _classCount;
+    // _next[state * _classCount + class]
+    std::vector< State > _next;
+    State _initial;
+    State _matched;
+};
+
+// Whether the extension of a file name, from its last dot, is one of the
+// set; the same as comparing extension(name) with every item. The
+// extensions are kept reversed in a trie that is walked from the end of
+// the name, so the name is read once and nothing is allocated.
+class ExtensionMatcher
+{
+public:
+    ExtensionMatcher();
+    explicit ExtensionMatcher(const std::vector< std::string > &extensions);
+
+    bool matches(const char *name, size_t size) const;
+    bool matches(const std::string &name) const
+    {
+        return matches(name.data(), name.size());
+    }
+
+private:
+    struct Node
+    {
+        uint32_t firstChild;
+        uint32_t nextSibling;
+        char ch;
+        bool isEnd;
+    };
+
+    uint32_t child(uint32_t node, char ch) const;
+
+    // root at 0
+    std::vector< Node > _nodes;
+    // the set has "", names without extension match
+    bool _matchesNone;
+};
+
+#endif // STRING_MATCHERS_HPP
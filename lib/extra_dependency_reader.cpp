@@ -7,6 +7,7 @@
 
 #include <sstream>
 #include <array>
+#include <cstring>
 
 static std::string error_missing_argument(const std::string &path_to_json,
                                           const std::string &arg)
@@ -136,6 +137,6 @@ void ExtraDependencyReader::set_extra_dependencies(
         }
         auto fs = depNode->getFiles();
         for (FileNode *depFile : fs)
-            file->addExplicitDep(depFile);
+            tree.addExtraDependency(file, depFile);
     }
 }
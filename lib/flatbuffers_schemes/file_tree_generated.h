@@ -12,6 +12,8 @@ struct ListSplitted;
 
 struct FileRecord;
 
+struct Declaration;
+
 struct FileTree;
 
 struct ListSplitted FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
@@ -88,11 +90,25 @@ struct FileRecord FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
     VT_INHERITANCES = 12,
     VT_CLASS_DECLS = 14,
     VT_FUNCTION_DECLS = 16,
-    VT_USING_NAMESPACES = 18
+    VT_USING_NAMESPACES = 18,
+    VT_MTIME_NS = 20,
+    VT_SIZE = 22,
+    VT_INODE = 24,
+    VT_ID = 26,
+    VT_INCLUDE_FILES = 28,
+    VT_BASE_CLASS_FILES = 30,
+    VT_FUNC_IMPL_FILES = 32,
+    VT_CLASS_IMPL_FILES = 34
   };
   const flatbuffers::String *path() const {
     return GetPointer<const flatbuffers::String *>(VT_PATH);
   }
+  bool KeyCompareLessThan(const FileRecord *o) const {
+    return *path() < *o->path();
+  }
+  int KeyCompareWithValue(const char *val) const {
+    return strcmp(path()->c_str(), val);
+  }
   const flatbuffers::Vector<uint8_t> *md5() const {
     return GetPointer<const flatbuffers::Vector<uint8_t> *>(VT_MD5);
   }
@@ -114,6 +130,30 @@ struct FileRecord FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   const ListSplitted *using_namespaces() const {
     return GetPointer<const ListSplitted *>(VT_USING_NAMESPACES);
   }
+  uint64_t mtime_ns() const {
+    return GetField<uint64_t>(VT_MTIME_NS, 0);
+  }
+  uint64_t size() const {
+    return GetField<uint64_t>(VT_SIZE, 0);
+  }
+  uint64_t inode() const {
+    return GetField<uint64_t>(VT_INODE, 0);
+  }
+  uint32_t id() const {
+    return GetField<uint32_t>(VT_ID, 0);
+  }
+  const flatbuffers::Vector<uint32_t> *include_files() const {
+    return GetPointer<const flatbuffers::Vector<uint32_t> *>(VT_INCLUDE_FILES);
+  }
+  const flatbuffers::Vector<uint32_t> *base_class_files() const {
+    return GetPointer<const flatbuffers::Vector<uint32_t> *>(VT_BASE_CLASS_FILES);
+  }
+  const flatbuffers::Vector<uint32_t> *func_impl_files() const {
+    return GetPointer<const flatbuffers::Vector<uint32_t> *>(VT_FUNC_IMPL_FILES);
+  }
+  const flatbuffers::Vector<uint32_t> *class_impl_files() const {
+    return GetPointer<const flatbuffers::Vector<uint32_t> *>(VT_CLASS_IMPL_FILES);
+  }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyOffset(verifier, VT_PATH) &&
@@ -133,6 +173,18 @@ struct FileRecord FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
            verifier.VerifyTable(function_decls()) &&
            VerifyOffset(verifier, VT_USING_NAMESPACES) &&
            verifier.VerifyTable(using_namespaces()) &&
+           VerifyField<uint64_t>(verifier, VT_MTIME_NS) &&
+           VerifyField<uint64_t>(verifier, VT_SIZE) &&
+           VerifyField<uint64_t>(verifier, VT_INODE) &&
+           VerifyField<uint32_t>(verifier, VT_ID) &&
+           VerifyOffset(verifier, VT_INCLUDE_FILES) &&
+           verifier.VerifyVector(include_files()) &&
+           VerifyOffset(verifier, VT_BASE_CLASS_FILES) &&
+           verifier.VerifyVector(base_class_files()) &&
+           VerifyOffset(verifier, VT_FUNC_IMPL_FILES) &&
+           verifier.VerifyVector(func_impl_files()) &&
+           VerifyOffset(verifier, VT_CLASS_IMPL_FILES) &&
+           verifier.VerifyVector(class_impl_files()) &&
            verifier.EndTable();
   }
 };
@@ -164,6 +216,30 @@ struct FileRecordBuilder {
   void add_using_namespaces(flatbuffers::Offset<ListSplitted> using_namespaces) {
     fbb_.AddOffset(FileRecord::VT_USING_NAMESPACES, using_namespaces);
   }
+  void add_mtime_ns(uint64_t mtime_ns) {
+    fbb_.AddElement<uint64_t>(FileRecord::VT_MTIME_NS, mtime_ns, 0);
+  }
+  void add_size(uint64_t size) {
+    fbb_.AddElement<uint64_t>(FileRecord::VT_SIZE, size, 0);
+  }
+  void add_inode(uint64_t inode) {
+    fbb_.AddElement<uint64_t>(FileRecord::VT_INODE, inode, 0);
+  }
+  void add_id(uint32_t id) {
+    fbb_.AddElement<uint32_t>(FileRecord::VT_ID, id, 0);
+  }
+  void add_include_files(flatbuffers::Offset<flatbuffers::Vector<uint32_t>> include_files) {
+    fbb_.AddOffset(FileRecord::VT_INCLUDE_FILES, include_files);
+  }
+  void add_base_class_files(flatbuffers::Offset<flatbuffers::Vector<uint32_t>> base_class_files) {
+    fbb_.AddOffset(FileRecord::VT_BASE_CLASS_FILES, base_class_files);
+  }
+  void add_func_impl_files(flatbuffers::Offset<flatbuffers::Vector<uint32_t>> func_impl_files) {
+    fbb_.AddOffset(FileRecord::VT_FUNC_IMPL_FILES, func_impl_files);
+  }
+  void add_class_impl_files(flatbuffers::Offset<flatbuffers::Vector<uint32_t>> class_impl_files) {
+    fbb_.AddOffset(FileRecord::VT_CLASS_IMPL_FILES, class_impl_files);
+  }
   explicit FileRecordBuilder(flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -185,8 +261,24 @@ inline flatbuffers::Offset<FileRecord> CreateFileRecord(
     flatbuffers::Offset<ListSplitted> inheritances = 0,
     flatbuffers::Offset<ListSplitted> class_decls = 0,
     flatbuffers::Offset<ListSplitted> function_decls = 0,
-    flatbuffers::Offset<ListSplitted> using_namespaces = 0) {
+    flatbuffers::Offset<ListSplitted> using_namespaces = 0,
+    uint64_t mtime_ns = 0,
+    uint64_t size = 0,
+    uint64_t inode = 0,
+    uint32_t id = 0,
+    flatbuffers::Offset<flatbuffers::Vector<uint32_t>> include_files = 0,
+    flatbuffers::Offset<flatbuffers::Vector<uint32_t>> base_class_files = 0,
+    flatbuffers::Offset<flatbuffers::Vector<uint32_t>> func_impl_files = 0,
+    flatbuffers::Offset<flatbuffers::Vector<uint32_t>> class_impl_files = 0) {
   FileRecordBuilder builder_(_fbb);
+  builder_.add_inode(inode);
+  builder_.add_size(size);
+  builder_.add_mtime_ns(mtime_ns);
+  builder_.add_class_impl_files(class_impl_files);
+  builder_.add_func_impl_files(func_impl_files);
+  builder_.add_base_class_files(base_class_files);
+  builder_.add_include_files(include_files);
+  builder_.add_id(id);
   builder_.add_using_namespaces(using_namespaces);
   builder_.add_function_decls(function_decls);
   builder_.add_class_decls(class_decls);
@@ -207,10 +299,22 @@ inline flatbuffers::Offset<FileRecord> CreateFileRecordDirect(
     flatbuffers::Offset<ListSplitted> inheritances = 0,
     flatbuffers::Offset<ListSplitted> class_decls = 0,
     flatbuffers::Offset<ListSplitted> function_decls = 0,
-    flatbuffers::Offset<ListSplitted> using_namespaces = 0) {
+    flatbuffers::Offset<ListSplitted> using_namespaces = 0,
+    uint64_t mtime_ns = 0,
+    uint64_t size = 0,
+    uint64_t inode = 0,
+    uint32_t id = 0,
+    const std::vector<uint32_t> *include_files = nullptr,
+    const std::vector<uint32_t> *base_class_files = nullptr,
+    const std::vector<uint32_t> *func_impl_files = nullptr,
+    const std::vector<uint32_t> *class_impl_files = nullptr) {
   auto path__ = path ? _fbb.CreateString(path) : 0;
   auto md5__ = md5 ? _fbb.CreateVector<uint8_t>(*md5) : 0;
   auto includes__ = includes ? _fbb.CreateVector<flatbuffers::Offset<flatbuffers::String>>(*includes) : 0;
+  auto include_files__ = include_files ? _fbb.CreateVector<uint32_t>(*include_files) : 0;
+  auto base_class_files__ = base_class_files ? _fbb.CreateVector<uint32_t>(*base_class_files) : 0;
+  auto func_impl_files__ = func_impl_files ? _fbb.CreateVector<uint32_t>(*func_impl_files) : 0;
+  auto class_impl_files__ = class_impl_files ? _fbb.CreateVector<uint32_t>(*class_impl_files) : 0;
   return LazyUT::CreateFileRecord(
       _fbb,
       path__,
@@ -220,13 +324,97 @@ inline flatbuffers::Offset<FileRecord> CreateFileRecordDirect(
       inheritances,
       class_decls,
       function_decls,
-      using_namespaces);
+      using_namespaces,
+      mtime_ns,
+      size,
+      inode,
+      id,
+      include_files__,
+      base_class_files__,
+      func_impl_files__,
+      class_impl_files__);
+}
+
+struct Declaration FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_NAME = 4,
+    VT_FILES = 6
+  };
+  const flatbuffers::String *name() const {
+    return GetPointer<const flatbuffers::String *>(VT_NAME);
+  }
+  bool KeyCompareLessThan(const Declaration *o) const {
+    return *name() < *o->name();
+  }
+  int KeyCompareWithValue(const char *val) const {
+    return strcmp(name()->c_str(), val);
+  }
+  const flatbuffers::Vector<uint32_t> *files() const {
+    return GetPointer<const flatbuffers::Vector<uint32_t> *>(VT_FILES);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_NAME) &&
+           verifier.VerifyString(name()) &&
+           VerifyOffset(verifier, VT_FILES) &&
+           verifier.VerifyVector(files()) &&
+           verifier.EndTable();
+  }
+};
+
+struct DeclarationBuilder {
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_name(flatbuffers::Offset<flatbuffers::String> name) {
+    fbb_.AddOffset(Declaration::VT_NAME, name);
+  }
+  void add_files(flatbuffers::Offset<flatbuffers::Vector<uint32_t>> files) {
+    fbb_.AddOffset(Declaration::VT_FILES, files);
+  }
+  explicit DeclarationBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  DeclarationBuilder &operator=(const DeclarationBuilder &);
+  flatbuffers::Offset<Declaration> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<Declaration>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<Declaration> CreateDeclaration(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::String> name = 0,
+    flatbuffers::Offset<flatbuffers::Vector<uint32_t>> files = 0) {
+  DeclarationBuilder builder_(_fbb);
+  builder_.add_files(files);
+  builder_.add_name(name);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<Declaration> CreateDeclarationDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const char *name = nullptr,
+    const std::vector<uint32_t> *files = nullptr) {
+  auto name__ = name ? _fbb.CreateString(name) : 0;
+  auto files__ = files ? _fbb.CreateVector<uint32_t>(*files) : 0;
+  return LazyUT::CreateDeclaration(
+      _fbb,
+      name__,
+      files__);
 }
 
 struct FileTree FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
     VT_ROOTPATH = 4,
-    VT_RECORDS = 6
+    VT_RECORDS = 6,
+    VT_HASH_ALGORITHM = 8,
+    VT_VERSION = 10,
+    VT_NEXT_FILE_ID = 12,
+    VT_INCLUDE_PATHS = 14,
+    VT_CLASS_DECLS = 16,
+    VT_FUNCTION_DECLS = 18
   };
   const flatbuffers::String *rootPath() const {
     return GetPointer<const flatbuffers::String *>(VT_ROOTPATH);
@@ -234,6 +422,24 @@ struct FileTree FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   const flatbuffers::Vector<flatbuffers::Offset<FileRecord>> *records() const {
     return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<FileRecord>> *>(VT_RECORDS);
   }
+  uint8_t hash_algorithm() const {
+    return GetField<uint8_t>(VT_HASH_ALGORITHM, 0);
+  }
+  uint32_t version() const {
+    return GetField<uint32_t>(VT_VERSION, 0);
+  }
+  uint32_t next_file_id() const {
+    return GetField<uint32_t>(VT_NEXT_FILE_ID, 0);
+  }
+  const flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>> *include_paths() const {
+    return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>> *>(VT_INCLUDE_PATHS);
+  }
+  const flatbuffers::Vector<flatbuffers::Offset<Declaration>> *class_decls() const {
+    return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<Declaration>> *>(VT_CLASS_DECLS);
+  }
+  const flatbuffers::Vector<flatbuffers::Offset<Declaration>> *function_decls() const {
+    return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<Declaration>> *>(VT_FUNCTION_DECLS);
+  }
   bool Verify(flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyOffset(verifier, VT_ROOTPATH) &&
@@ -241,6 +447,18 @@ struct FileTree FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
            VerifyOffset(verifier, VT_RECORDS) &&
            verifier.VerifyVector(records()) &&
            verifier.VerifyVectorOfTables(records()) &&
+           VerifyField<uint8_t>(verifier, VT_HASH_ALGORITHM) &&
+           VerifyField<uint32_t>(verifier, VT_VERSION) &&
+           VerifyField<uint32_t>(verifier, VT_NEXT_FILE_ID) &&
+           VerifyOffset(verifier, VT_INCLUDE_PATHS) &&
+           verifier.VerifyVector(include_paths()) &&
+           verifier.VerifyVectorOfStrings(include_paths()) &&
+           VerifyOffset(verifier, VT_CLASS_DECLS) &&
+           verifier.VerifyVector(class_decls()) &&
+           verifier.VerifyVectorOfTables(class_decls()) &&
+           VerifyOffset(verifier, VT_FUNCTION_DECLS) &&
+           verifier.VerifyVector(function_decls()) &&
+           verifier.VerifyVectorOfTables(function_decls()) &&
            verifier.EndTable();
   }
 };
@@ -254,6 +472,24 @@ struct FileTreeBuilder {
   void add_records(flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<FileRecord>>> records) {
     fbb_.AddOffset(FileTree::VT_RECORDS, records);
   }
+  void add_hash_algorithm(uint8_t hash_algorithm) {
+    fbb_.AddElement<uint8_t>(FileTree::VT_HASH_ALGORITHM, hash_algorithm, 0);
+  }
+  void add_version(uint32_t version) {
+    fbb_.AddElement<uint32_t>(FileTree::VT_VERSION, version, 0);
+  }
+  void add_next_file_id(uint32_t next_file_id) {
+    fbb_.AddElement<uint32_t>(FileTree::VT_NEXT_FILE_ID, next_file_id, 0);
+  }
+  void add_include_paths(flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>>> include_paths) {
+    fbb_.AddOffset(FileTree::VT_INCLUDE_PATHS, include_paths);
+  }
+  void add_class_decls(flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<Declaration>>> class_decls) {
+    fbb_.AddOffset(FileTree::VT_CLASS_DECLS, class_decls);
+  }
+  void add_function_decls(flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<Declaration>>> function_decls) {
+    fbb_.AddOffset(FileTree::VT_FUNCTION_DECLS, function_decls);
+  }
   explicit FileTreeBuilder(flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -269,23 +505,50 @@ struct FileTreeBuilder {
 inline flatbuffers::Offset<FileTree> CreateFileTree(
     flatbuffers::FlatBufferBuilder &_fbb,
     flatbuffers::Offset<flatbuffers::String> rootPath = 0,
-    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<FileRecord>>> records = 0) {
+    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<FileRecord>>> records = 0,
+    uint8_t hash_algorithm = 0,
+    uint32_t version = 0,
+    uint32_t next_file_id = 0,
+    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>>> include_paths = 0,
+    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<Declaration>>> class_decls = 0,
+    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<Declaration>>> function_decls = 0) {
   FileTreeBuilder builder_(_fbb);
+  builder_.add_function_decls(function_decls);
+  builder_.add_class_decls(class_decls);
+  builder_.add_include_paths(include_paths);
+  builder_.add_next_file_id(next_file_id);
+  builder_.add_version(version);
   builder_.add_records(records);
   builder_.add_rootPath(rootPath);
+  builder_.add_hash_algorithm(hash_algorithm);
   return builder_.Finish();
 }
 
 inline flatbuffers::Offset<FileTree> CreateFileTreeDirect(
     flatbuffers::FlatBufferBuilder &_fbb,
     const char *rootPath = nullptr,
-    const std::vector<flatbuffers::Offset<FileRecord>> *records = nullptr) {
+    const std::vector<flatbuffers::Offset<FileRecord>> *records = nullptr,
+    uint8_t hash_algorithm = 0,
+    uint32_t version = 0,
+    uint32_t next_file_id = 0,
+    const std::vector<flatbuffers::Offset<flatbuffers::String>> *include_paths = nullptr,
+    const std::vector<flatbuffers::Offset<Declaration>> *class_decls = nullptr,
+    const std::vector<flatbuffers::Offset<Declaration>> *function_decls = nullptr) {
   auto rootPath__ = rootPath ? _fbb.CreateString(rootPath) : 0;
   auto records__ = records ? _fbb.CreateVector<flatbuffers::Offset<FileRecord>>(*records) : 0;
+  auto include_paths__ = include_paths ? _fbb.CreateVector<flatbuffers::Offset<flatbuffers::String>>(*include_paths) : 0;
+  auto class_decls__ = class_decls ? _fbb.CreateVector<flatbuffers::Offset<Declaration>>(*class_decls) : 0;
+  auto function_decls__ = function_decls ? _fbb.CreateVector<flatbuffers::Offset<Declaration>>(*function_decls) : 0;
   return LazyUT::CreateFileTree(
       _fbb,
       rootPath__,
-      records__);
+      records__,
+      hash_algorithm,
+      version,
+      next_file_id,
+      include_paths__,
+      class_decls__,
+      function_decls__);
 }
 
 inline const LazyUT::FileTree *GetFileTree(const void *buf) {
@@ -0,0 +1,211 @@
+#ifndef CHAR_SCAN_HPP
+#define CHAR_SCAN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CHAR_SCAN_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Scanning of the source text for the tokenizer and the include scanner.
+// Runs of identifier characters and spaces are skipped and terminators are
+// found 16 bytes at a time with SSE2, byte by byte through the class table
+// elsewhere and at the ends of the text. Comment ends are found by memchr(),
+// which libc vectorizes for the widest instruction set of the machine.
+// Classes are those of the "C" locale: bytes above 0x7f are neither
+// textual nor space.
+
+enum class CharClass : uint8_t { Space, Textual, Other };
+
+class CharClassTable
+{
+public:
+    constexpr CharClassTable() : _classes()
+    {
+        for (int ch = 0; ch < 256; ++ch)
+            _classes[ch] = classify(ch);
+    }
+
+    CharClass operator[](char ch) const
+    {
+        return _classes[static_cast< unsigned char >(ch)];
+    }
+
+private:
+    static constexpr CharClass classify(int ch)
+    {
+        return ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') ||
+                (ch >= '0' && ch <= '9') || ch == '_')
+                   ? CharClass::Textual
+                   : (ch == ' ' || (ch >= '\t' && ch <= '\r'))
+                         ? CharClass::Space
+                         : CharClass::Other;
+    }
+
+    CharClass _classes[256];
+};
+
+constexpr CharClassTable charClasses;
+
+namespace CharScan {
+
+inline unsigned lowestBit(uint32_t mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+#ifdef CHAR_SCAN_SSE2
+const size_t blockSize = 16;
+
+inline __m128i load(const char *p)
+{
+    return _mm_loadu_si128(reinterpret_cast< const __m128i * >(p));
+}
+
+inline uint32_t bytesEqual(__m128i block, char ch)
+{
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(ch)));
+}
+
+// the comparisons are signed, bytes above 0x7f are below every bound
+inline __m128i inRange(__m128i block, char first, char last)
+{
+    return _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8(first - 1)),
+                         _mm_cmpgt_epi8(_mm_set1_epi8(last + 1), block));
+}
+
+inline uint32_t textualBytes(__m128i block)
+{
+    const __m128i lower = _mm_or_si128(block, _mm_set1_epi8(0x20));
+    const __m128i textual = _mm_or_si128(
+        _mm_or_si128(inRange(lower, 'a', 'z'), inRange(block, '0', '9')),
+        _mm_cmpeq_epi8(block, _mm_set1_epi8('_')));
+    return _mm_movemask_epi8(textual);
+}
+
+inline uint32_t spaceBytes(__m128i block)
+{
+    const __m128i space =
+        _mm_or_si128(inRange(block, '\t', '\r'),
+                     _mm_cmpeq_epi8(block, _mm_set1_epi8(' ')));
+    return _mm_movemask_epi8(space);
+}
+#endif
+
+// the first byte in [p, end) not of the class
+inline const char *skipTextual(const char *p, const char *end)
+{
+#ifdef CHAR_SCAN_SSE2
+    for (; end - p >= static_cast< ptrdiff_t >(blockSize); p += blockSize) {
+        if (uint32_t other = ~textualBytes(load(p)) & 0xffff)
+            return p + lowestBit(other);
+    }
+#endif
+    while (p < end && charClasses[*p] == CharClass::Textual)
+        ++p;
+    return p;
+}
+
+inline const char *skipSpaces(const char *p, const char *end)
+{
+#ifdef CHAR_SCAN_SSE2
+    for (; end - p >= static_cast< ptrdiff_t >(blockSize); p += blockSize) {
+        if (uint32_t other = ~spaceBytes(load(p)) & 0xffff)
+            return p + lowestBit(other);
+    }
+#endif
+    while (p < end && charClasses[*p] == CharClass::Space)
+        ++p;
+    return p;
+}
+
+// the first of the two bytes in [p, end), end if there is none
+inline const char *findEither(const char *p, const char *end, char first,
+                              char second)
+{
+#ifdef CHAR_SCAN_SSE2
+    for (; end - p >= static_cast< ptrdiff_t >(blockSize); p += blockSize) {
+        const __m128i block = load(p);
+        const uint32_t found =
+            bytesEqual(block, first) | bytesEqual(block, second);
+        if (found)
+            return p + lowestBit(found);
+    }
+#endif
+    while (p < end && *p != first && *p != second)
+        ++p;
+    return p;
+}
+
+// the closing quote of a string from p, past the opening one; a backslash
+// escapes the next byte. end if there is none
+inline const char *findQuote(const char *p, const char *end, char quote)
+{
+    for (; (p = findEither(p, end, '\\', quote)) < end; ++p) {
+        if (*p == quote)
+            return p;
+        ++p;
+    }
+    return end;
+}
+
+// past the line end of a // comment from p, a line end escaped by a
+// backslash continues the comment
+inline const char *skipLineComment(const char *p, const char *end)
+{
+    for (; p < end; ++p) {
+        p = static_cast< const char * >(memchr(p, '\n', end - p));
+        if (!p)
+            break;
+        if (p[-1] != '\\')
+            return p + 1;
+    }
+    return end;
+}
+
+// past the */ of a /* comment from p, end if there is none
+inline const char *skipBlockComment(const char *p, const char *end)
+{
+    for (; p < end; ++p) {
+        p = static_cast< const char * >(memchr(p, '*', end - p));
+        if (!p)
+            break;
+        if (p + 1 < end && p[1] == '/')
+            return p + 2;
+    }
+    return end;
+}
+
+template < typename TFunc >
+void forEachNewline(const char *p, const char *end, TFunc f)
+{
+#ifdef CHAR_SCAN_SSE2
+    for (; end - p >= static_cast< ptrdiff_t >(blockSize); p += blockSize) {
+        for (uint32_t found = bytesEqual(load(p), '\n'); found;
+             found &= found - 1)
+            f(p + lowestBit(found));
+    }
+#endif
+    for (; p < end; ++p) {
+        if (*p == '\n')
+            f(p);
+    }
+}
+
+} // namespace CharScan
+
+#endif // CHAR_SCAN_HPP
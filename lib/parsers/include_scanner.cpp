@@ -0,0 +1,237 @@
+#include "include_scanner.hpp"
+
+#include "char_scan.hpp"
+
+#include <types/file_tree.hpp>
+
+#include <algorithm> // min
+#include <cstring>   // memcmp, strlen
+
+IncludeScanner::IncludeScanner()
+    : _isExact(true), _end(nullptr), _hasDeclarationWord(false)
+{}
+
+bool IncludeScanner::scan(const char *text, size_t size,
+                          std::vector< IncludeDirective > &includes)
+{
+    _isExact = true;
+    return walk(text, size, includes);
+}
+
+void IncludeScanner::readIncludes(const char *text, size_t size,
+                                  std::vector< IncludeDirective > &includes)
+{
+    _isExact = false;
+    walk(text, size, includes);
+}
+
+bool IncludeScanner::walk(const char *text, size_t size,
+                          std::vector< IncludeDirective > &includes)
+{
+    // a word or a symbol running to the end of the text is not a token,
+    // leave the file to the parser rather than follow it there
+    if (_isExact && size > 0 &&
+        charClasses[text[size - 1]] != CharClass::Space)
+        return false;
+    _end = text + size;
+    _hasDeclarationWord = false;
+
+    Lexeme lexeme = {TokenName::Undefined, 0, text, text, 1};
+    int openCurlyBracketCount = 0;
+    bool isLexeme = next(lexeme);
+    while (isLexeme) {
+        if (_isExact && _hasDeclarationWord)
+            return false;
+
+        switch (lexeme.name) {
+        case TokenName::Hash:
+            if (!readDirective(lexeme, includes))
+                return false;
+            // the lexeme past the directive, the last one of the text is
+            // taken once more as the parser does
+            continue;
+        case TokenName::BracketCurlyLeft:
+            ++openCurlyBracketCount;
+            break;
+        case TokenName::BracketCurlyRight:
+            // the parser stops at a broken sequence
+            if (--openCurlyBracketCount < 0)
+                return false;
+            break;
+        case TokenName::BracketLeft:
+        case TokenName::DoubleColon:
+        case TokenName::Using:
+        case TokenName::Extern:
+            if (_isExact)
+                return false;
+            break;
+        default:
+            break;
+        }
+        isLexeme = next(lexeme);
+    }
+    return !(_isExact && _hasDeclarationWord);
+}
+
+bool IncludeScanner::next(Lexeme &lexeme)
+{
+    const char *p = lexeme.next;
+    while (p < _end) {
+        const char *begin = p;
+        const char *lexemeEnd = p;
+        TokenName name = TokenName::Undefined;
+        switch (charClasses[*p]) {
+        case CharClass::Space:
+            p = CharScan::skipSpaces(p + 1, _end);
+            continue;
+        case CharClass::Textual:
+            lexemeEnd = CharScan::skipTextual(p + 1, _end);
+            if (lexemeEnd == _end)
+                return false;
+            name = key_word_table.find(p, lexemeEnd - p);
+            if (Token(name, 0, 0).isClass() ||
+                Token(name, 0, 0).isInheritance())
+                _hasDeclarationWord = true;
+            break;
+        case CharClass::Other: {
+            const char *q = p;
+            SymbolAutomaton::State state = SymbolAutomaton::root;
+            for (; q < _end; ++q) {
+                state = symbol_automaton.next(state, *q);
+                if (state == SymbolAutomaton::dead)
+                    break;
+                if (symbol_automaton.accepted(state) != TokenName::Undefined) {
+                    name = symbol_automaton.accepted(state);
+                    lexemeEnd = q + 1;
+                }
+            }
+            if (q == _end)
+                return false;
+            if (q == p) { // not a symbol
+                ++p;
+                continue;
+            }
+            break;
+        }
+        }
+
+        const char *following = lexemeEnd;
+        switch (name) {
+        case TokenName::SingleQuote:
+        case TokenName::DoubleQuote:
+            begin = lexemeEnd;
+            lexemeEnd = CharScan::findQuote(
+                begin, _end, (name == TokenName::SingleQuote) ? '\'' : '\"');
+            following = std::min(lexemeEnd + 1, _end);
+            name = TokenName::String;
+            break;
+        case TokenName::DoubleSlash:
+            p = CharScan::skipLineComment(lexemeEnd, _end);
+            continue;
+        case TokenName::SlashStar:
+            p = CharScan::skipBlockComment(lexemeEnd, _end);
+            continue;
+        default:
+            break;
+        }
+
+        // the line ends within strings aren't counted
+        unsigned line = lexeme.line;
+        CharScan::forEachNewline(lexeme.next, begin,
+                                 [&line](const char *) { ++line; });
+        lexeme = Lexeme{name, static_cast< LengthType >(lexemeEnd - begin),
+                        begin, following, line};
+        return true;
+    }
+    return false;
+}
+
+bool IncludeScanner::readDirective(
+    Lexeme &lexeme, std::vector< IncludeDirective > &includes)
+{
+    // the parser throws on a directive running to the end of the text
+    if (!next(lexeme))
+        return false;
+
+    if (lexeme.name == TokenName::Include) {
+        IncludeDirective dir;
+        if (!next(lexeme) || !readFilename(lexeme, dir))
+            return false;
+        if (!dir.filename.empty())
+            includes.push_back(dir);
+        else if (_isExact) // the parser warns about the directive
+            return false;
+    }
+    else if (isWord(lexeme, "else") || isWord(lexeme, "elif")) {
+        skipLine(lexeme);
+        skipUntilEndif(lexeme);
+    }
+    skipLine(lexeme);
+    return true;
+}
+
+bool IncludeScanner::readFilename(Lexeme &lexeme, IncludeDirective &dir)
+{
+    if (lexeme.name == TokenName::String) {
+        dir.type = IncludeDirective::Quotes;
+        dir.filename.assign(lexeme.begin, lexeme.length);
+    }
+    else if (lexeme.name == TokenName::Less) {
+        if (!next(lexeme))
+            return false;
+
+        dir.type = IncludeDirective::Brackets;
+        std::string path;
+        while (lexeme.name == TokenName::Identifier ||
+               lexeme.name == TokenName::Slash ||
+               lexeme.name == TokenName::Dot ||
+               key_words.findLexeme(lexeme.name)) {
+            path.append(lexeme.begin, lexeme.length);
+            if (!next(lexeme))
+                return false;
+        }
+        dir.filename = SplittedPath(path, SplittedPath::unixSep()).jointUnix();
+    }
+    return true;
+}
+
+void IncludeScanner::skipLine(Lexeme &lexeme)
+{
+    unsigned line = lexeme.line;
+    Lexeme following = lexeme;
+    while (next(following)) {
+        if (lexeme.name == TokenName::Backslash)
+            line = following.line;
+
+        lexeme = following;
+        if (lexeme.line > line)
+            return;
+    }
+}
+
+void IncludeScanner::skipUntilEndif(Lexeme &lexeme)
+{
+    int deep = 1;
+    for (Lexeme key = lexeme; next(key); key = lexeme) {
+        if (lexeme.name == TokenName::Hash) {
+            if (isWord(key, "endif")) {
+                --deep;
+            }
+            else if (isWord(key, "if") || isWord(key, "ifdef") ||
+                     isWord(key, "elif")) {
+                ++deep;
+            }
+
+            if (deep == 0)
+                return;
+        }
+        skipLine(lexeme);
+    }
+}
+
+bool IncludeScanner::isWord(const Lexeme &lexeme, const char *word)
+{
+    return lexeme.name == TokenName::Identifier &&
+           lexeme.length == strlen(word) &&
+           memcmp(lexeme.begin, word, lexeme.length) == 0;
+}
@@ -0,0 +1,70 @@
+#ifndef INCLUDE_SCANNER_HPP
+#define INCLUDE_SCANNER_HPP
+
+#include "tokenizer.hpp"
+
+#include <vector>
+
+struct IncludeDirective;
+
+// Include directives of a source file without the declaration parser
+// (--fast-includes). The text is walked as the tokenizer does, but only the
+// directives are followed, and they are followed the way
+// SourceParser::parseFile() does: a directive takes the rest of its line
+// and the #else and #elif blocks are skipped. The scan gives up on a file
+// which may contribute declarations: one with the key words class, struct,
+// public, private or protected anywhere, or with a parenthesis, a using,
+// an extern or a :: outside of the directives.
+class IncludeScanner
+{
+public:
+    IncludeScanner();
+
+    // Appends the include directives SourceParser would find in the text,
+    // in its order. False if the file is to be parsed in full, the
+    // directives are unspecified then.
+    bool scan(const char *text, size_t size,
+              std::vector< IncludeDirective > &includes);
+    // The same, but the file is taken as declaring nothing; the directives
+    // are those of the parser but where a declaration takes them in.
+    void readIncludes(const char *text, size_t size,
+                      std::vector< IncludeDirective > &includes);
+
+private:
+    // a token of the text, with its line as the tokenizer counts them
+    struct Lexeme
+    {
+        TokenName name;
+        LengthType length;
+        const char *begin;
+        // where the next lexeme starts, past the closing quote of a string
+        const char *next;
+        unsigned line;
+    };
+
+    // false if the text isn't followed to the end, or is to be parsed in
+    // full when _isExact
+    bool walk(const char *text, size_t size,
+              std::vector< IncludeDirective > &includes);
+    // the lexeme after the given one, false at the end of the text
+    bool next(Lexeme &lexeme);
+
+    bool readDirective(Lexeme &lexeme,
+                       std::vector< IncludeDirective > &includes);
+    // false at the end of the text, the name is empty where the parser
+    // takes none
+    bool readFilename(Lexeme &lexeme, IncludeDirective &dir);
+    void skipLine(Lexeme &lexeme);
+    void skipUntilEndif(Lexeme &lexeme);
+
+    static bool isWord(const Lexeme &lexeme, const char *word);
+
+private:
+    bool _isExact;
+    const char *_end;
+    // a key word the backward scans of the parser take a declaration from,
+    // they reach into the directives too
+    bool _hasDeclarationWord;
+};
+
+#endif // INCLUDE_SCANNER_HPP
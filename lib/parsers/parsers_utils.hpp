@@ -2,6 +2,7 @@
 #define PARSERS_UTILS_HPP
 
 #include <map>
+#include <cstddef> // size_t
 
 template < typename T >
 class TreeNode
@@ -3,12 +3,20 @@
 
 #include <types/file_tree.hpp>
 
+#include <climits>
 #include <set>
 #include <map>
 
 #define M_MIN(a, b) (((a) < (b)) ? (a) : (b))
 #define M_MAX(a, b) (((a) > (b)) ? (a) : (b))
 
+namespace {
+
+// parse up to the end of the file
+const int untilEnd = INT_MAX;
+
+} // namespace
+
 static decltype(auto) initOverloadingOperators()
 {
     std::vector< std::vector< TokenName > > operators = {
@@ -64,16 +72,16 @@ static decltype(auto) initOverloadingOperators()
     return root;
 }
 
-bool SourceParser::parseScopedName(const SourceParser::TokenVector &v,
-                                   int start, int end, SplittedPath &name)
+bool SourceParser::parseScopedName(TokenStream &v, int start, int end,
+                                   SplittedPath &name)
 {
     bool inserted = false;
-    for (; start < end; ++start) {
+    for (; start < end && v.has(start); ++start) {
         const Token &token = v[start];
 
         switch (token.name) {
         case TokenName::Identifier:
-            name.append(token.lexeme_str());
+            name.append(v.tokenizer().lexeme_str(token));
             inserted = true;
             break;
         case TokenName::Final:
@@ -96,8 +104,7 @@ bool SourceParser::parseScopedName(const SourceParser::TokenVector &v,
     return inserted;
 }
 
-int SourceParser::getIdentifierStart(const SourceParser::TokenVector &v,
-                                     int offset) const
+int SourceParser::getIdentifierStart(TokenStream &v, int offset) const
 {
     --offset;
     skipOperatorOverloadingReverse(v, offset);
@@ -107,61 +114,59 @@ int SourceParser::getIdentifierStart(const SourceParser::TokenVector &v,
         TokenNameSet({TokenName::Identifier, TokenName::Operator,
                       TokenName::DoubleColon, TokenName::Final});
 
-    for (; offset > 0; --offset) {
+    for (; offset > v.first(); --offset) {
         if (name_type.find(v[offset - 1].name) == name_type.end() ||
             v[offset - 1].name == v[offset].name) {
             return offset;
         }
     }
-    return 0;
+    return v.first();
 }
 
-void SourceParser::skipOperatorOverloadingReverse(
-    const SourceParser::TokenVector &v, int &offset) const
+void SourceParser::skipOperatorOverloadingReverse(TokenStream &v,
+                                                  int &offset) const
 {
     static auto treeOverloadingOperator = initOverloadingOperators();
     std::vector< TokenName > revOperator;
     auto node = &treeOverloadingOperator;
     auto i = offset;
 
-    for (; i >= 0; --i) {
+    for (; i >= v.first(); --i) {
         if (auto tmp = node->find(v[i].name)) {
             node = tmp;
             continue;
         }
         break;
     }
-    if (v[i].name == TokenName::Operator && node->finite)
+    if (checkOffset(v, i) && v[i].name == TokenName::Operator && node->finite)
         offset = i;
 }
 
-void SourceParser::skipLine(const SourceParser::TokenVector &tokens,
-                            int &offset) const
+void SourceParser::skipLine(TokenStream &tokens, int &offset) const
 {
-    int line = tokens[offset].n_line;
-    int sizeM1 = tokens.size() - 1;
-    for (; offset < sizeM1;) {
+    unsigned line = tokens.line(offset);
+    while (tokens.has(offset + 1)) {
         if (tokens[offset].name == TokenName::Backslash)
-            line = tokens[offset + 1].n_line;
+            line = tokens.line(offset + 1);
 
         increment_pp(offset);
-        if (tokens[offset].n_line > line)
+        if (tokens.line(offset) > line)
             return;
     }
 }
 
-void SourceParser::skipUntilEndif(const SourceParser::TokenVector &tokens,
-                                  int &offset) const
+void SourceParser::skipUntilEndif(TokenStream &tokens, int &offset) const
 {
     int deep = 1;
-    for (; offset + 1 < tokens.size(); skipLine(tokens, offset)) {
+    for (; tokens.has(offset + 1); skipLine(tokens, offset)) {
         if (tokens[offset].name == TokenName::Hash) {
             const Token &macroKeyToken = tokens[offset + 1];
-            if (macroKeyToken.isEndif()) {
+            if (tokens.tokenizer().isEndif(macroKeyToken)) {
                 --deep;
             }
-            else if (macroKeyToken.isIfMacro() || macroKeyToken.isIfdef() ||
-                     macroKeyToken.isElif()) {
+            else if (tokens.tokenizer().isIfMacro(macroKeyToken) ||
+                     tokens.tokenizer().isIfdef(macroKeyToken) ||
+                     tokens.tokenizer().isElif(macroKeyToken)) {
                 ++deep;
             }
 
@@ -172,8 +177,7 @@ void SourceParser::skipUntilEndif(const SourceParser::TokenVector &tokens,
     }
 }
 
-bool SourceParser::skipTemplate(const SourceParser::TokenVector &tokens,
-                                int &offset) const
+bool SourceParser::skipTemplate(TokenStream &tokens, int &offset) const
 {
     if (tokens[offset].name != TokenName::Less)
         return true;
@@ -210,10 +214,10 @@ bool SourceParser::skipTemplate(const SourceParser::TokenVector &tokens,
     return true;
 }
 
-bool SourceParser::skipTemplateReverse(const SourceParser::TokenVector &tokens,
-                                       int &offset) const
+bool SourceParser::skipTemplateReverse(TokenStream &tokens, int &offset) const
 {
-    if (tokens[offset].name != TokenName::Greater)
+    if (!checkOffset(tokens, offset) ||
+        tokens[offset].name != TokenName::Greater)
         return true;
     int depth = 0;
     int openBracketCount = 0;
@@ -260,10 +264,10 @@ void SourceParser::prepare()
     _listUsingNamespace.clear();
 }
 
-TokenName SourceParser::readUntil(const SourceParser::TokenVector &tokens,
-                                  int &offset, const TokenNameSet &tokenNames)
+TokenName SourceParser::readUntil(TokenStream &tokens, int &offset,
+                                  const TokenNameSet &tokenNames)
 {
-    for (; offset < tokens.size(); increment(tokens, offset)) {
+    for (; tokens.has(offset); increment(tokens, offset)) {
         auto it = tokenNames.find(tokens[offset].name);
         if (it != tokenNames.end())
             return *it;
@@ -271,8 +275,7 @@ TokenName SourceParser::readUntil(const SourceParser::TokenVector &tokens,
     return TokenName::Undefined;
 }
 
-void SourceParser::increment(const TokenVector &tokens, int &offset,
-                             bool checkRange)
+void SourceParser::increment(TokenStream &tokens, int &offset, bool checkRange)
 {
     const Token &token = tokens[offset];
     switch (token.name) {
@@ -311,8 +314,7 @@ void SourceParser::setNamespace()
     _stackNamespaceBrackets.push(_openCurlyBracketCount);
 }
 
-void SourceParser::dealWithClassDeclaration(
-    const SourceParser::TokenVector &tokens, int offset)
+void SourceParser::dealWithClassDeclaration(TokenStream &tokens, int offset)
 {
     ScopedName className = _currentNamespace;
     auto fstart = getIdentifierStart(tokens, offset);
@@ -326,7 +328,7 @@ void SourceParser::dealWithClassDeclaration(
             // class/struct inheritance
             _node->record()._setInheritances.insert(className);
             int nextOffset = fstart - 2;
-            if (nextOffset >= 0) {
+            if (checkOffset(tokens, nextOffset)) {
                 switch (tokens[nextOffset].name) {
                 case TokenName::Comma:
                 case TokenName::Colon:
@@ -340,13 +342,13 @@ void SourceParser::dealWithClassDeclaration(
     }
 }
 
-void SourceParser::parseIncludeFilename(const SourceParser::TokenVector &tokens,
-                                        int &offset, IncludeDirective &dir)
+void SourceParser::parseIncludeFilename(TokenStream &tokens, int &offset,
+                                        IncludeDirective &dir)
 {
     const Token &token = tokens[offset];
     if (token.name == TokenName::String) {
         dir.type = IncludeDirective::Quotes;
-        dir.filename = token.lexeme_str();
+        dir.filename = tokens.tokenizer().lexeme_str(token);
     }
     else if (token.name == TokenName::Less) {
         increment(tokens, offset, true);
@@ -358,16 +360,16 @@ void SourceParser::parseIncludeFilename(const SourceParser::TokenVector &tokens,
     }
 }
 
-void SourceParser::readPath(const SourceParser::TokenVector &tokens,
-                            int &offset, SplittedPath &path)
+void SourceParser::readPath(TokenStream &tokens, int &offset,
+                            SplittedPath &path)
 {
     std::string strPath;
-    for (; offset < tokens.size(); increment(tokens, offset, true)) {
+    for (; tokens.has(offset); increment(tokens, offset, true)) {
         const Token &token = tokens[offset];
         if (token.name == TokenName::Identifier ||
             token.name == TokenName::Slash || token.name == TokenName::Dot ||
             token.isKeyWord()) {
-            strPath += token.lexeme_str();
+            strPath += tokens.tokenizer().lexeme_str(token);
             continue;
         }
         break;
@@ -375,29 +377,25 @@ void SourceParser::readPath(const SourceParser::TokenVector &tokens,
     path = SplittedPath(strPath, SplittedPath::unixSep());
 }
 
-bool SourceParser::checkOffset(const SourceParser::TokenVector &tokens,
-                               int offset) const
+bool SourceParser::checkOffset(TokenStream &tokens, int offset) const
 {
-    return offset >= 0 && offset < tokens.size();
+    return offset >= tokens.first() && tokens.has(offset);
 }
 
-void SourceParser::assertOnBadRange(const SourceParser::TokenVector &tokens,
-                                    int offset) const
+void SourceParser::assertOnBadRange(TokenStream &tokens, int offset) const
 {
     if (!checkOffset(tokens, offset))
-        throw "unexpected end of tokens";
+        throw std::string("unexpected end of tokens");
 }
 
-bool SourceParser::isClassToken(const SourceParser::TokenVector &tokens,
-                                int offset) const
+bool SourceParser::isClassToken(TokenStream &tokens, int offset) const
 {
     if (!checkOffset(tokens, offset))
         return false;
     return tokens[offset].isClass();
 }
 
-bool SourceParser::isInheritanceToken(const SourceParser::TokenVector &tokens,
-                                      int offset) const
+bool SourceParser::isInheritanceToken(TokenStream &tokens, int offset) const
 {
     if (!checkOffset(tokens, offset))
         return false;
@@ -409,6 +407,24 @@ SourceParser::SourceParser(const FileTree &ftree) : _fileTree(ftree)
     _currentNamespace.setNamespaceSeparator();
 }
 
+bool SourceParser::scanIncludes(FileNode *node, const FileData &content,
+                                bool mayDeclare)
+{
+    std::vector< IncludeDirective > includes;
+    if (!mayDeclare)
+        _includeScanner.readIncludes(content.data.get(), content.size,
+                                     includes);
+    else if (!_includeScanner.scan(content.data.get(), content.size,
+                                   includes))
+        return false;
+
+    for (const IncludeDirective &dir : includes) {
+        if (_fileTree.searchIncludedFile(dir, node))
+            node->record()._listIncludes.push_back(dir);
+    }
+    return true;
+}
+
 void SourceParser::parseFile(FileNode *node)
 {
     if (!node->isSourceFile())
@@ -416,15 +432,24 @@ void SourceParser::parseFile(FileNode *node)
     _node = node;
 
     const SplittedPath &filename = node->fullPath();
-    Tokenizer tkn;
-    tkn.tokenize(filename);
-    const auto &tokens = tkn.tokens();
+    // the contents were read while hashing, the buffer is freed with the
+    // tokens of the next file
+    FileData content = node->record().takeContent();
+    if (_fileTree.isFastIncludes()) {
+        if (!content.data)
+            content = readFile(filename.jointOs().c_str(), "r");
+        if (content.data &&
+            scanIncludes(node, content, _fileTree.mayDeclare(node->name())))
+            return;
+    }
+    _tokens.open(filename, std::move(content));
+    TokenStream &tokens = _tokens;
 
     prepare();
 
     int i = 0;
     try {
-        for (; i < tokens.size();) {
+        for (; tokens.has(i);) {
             const Token &curTok = tokens[i];
             if (curTok.name == TokenName::Hash) {
                 // check if include directive
@@ -443,10 +468,11 @@ void SourceParser::parseFile(FileNode *node)
                     else {
                         errors() << "warning: skip include directive in file"
                                  << filename.jointOs() << "on the line"
-                                 << ntos(tokens[i].n_line);
+                                 << ntos(tokens.line(i));
                     }
                 }
-                else if (tokens[i].isElseMacro() || tokens[i].isElif()) {
+                else if (tokens.tokenizer().isElseMacro(tokens[i]) ||
+                         tokens.tokenizer().isElif(tokens[i])) {
                     skipLine(tokens, i);
                     // skip until endif (dont parse #else #endif blocks)
                     skipUntilEndif(tokens, i);
@@ -494,14 +520,14 @@ void SourceParser::parseFile(FileNode *node)
                     ScopedName ns;
                     ns.setNamespaceSeparator();
                     increment(tokens, i, true);
-                    parseScopedName(tokens, i, tokens.size(), ns);
+                    parseScopedName(tokens, i, untilEnd, ns);
                     if (!ns.empty())
                         node->record()._listUsingNamespace.push_back(ns);
                 }
                 break;
             case TokenName::Namespace:
                 increment(tokens, i, true);
-                parseScopedName(tokens, i, tokens.size(), _currentNamespace);
+                parseScopedName(tokens, i, untilEnd, _currentNamespace);
                 setNamespace();
                 break;
             case TokenName::Extern:
@@ -518,13 +544,22 @@ void SourceParser::parseFile(FileNode *node)
             default:
                 break;
             }
-            if (i < tokens.size())
+            if (tokens.has(i))
                 increment(tokens, i);
         }
     }
     catch (const std::string &msg) {
-        errors() << "Parsing of the file" << filename.joint()
-                 << "was stopped by the token" << tokens[i].toString()
-                 << "Reason:" << msg;
+        if (checkOffset(tokens, i))
+            errors() << "Parsing of the file" << filename.joint()
+                     << "was stopped by the token"
+                     << tokens.tokenizer().toString(tokens[i], tokens.line(i))
+                     << "Reason:" << msg;
+        else
+            errors() << "Parsing of the file" << filename.joint()
+                     << "was stopped at the end of the file"
+                     << "Reason:" << msg;
     }
+    // none of a file the tokenizer gave up
+    if (tokens.tokenizer().isSkipped())
+        node->record().clearParsedData();
 }
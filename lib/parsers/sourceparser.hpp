@@ -1,6 +1,7 @@
 #ifndef SOURCE_PARSER_HPP
 #define SOURCE_PARSER_HPP
 
+#include "include_scanner.hpp"
 #include "tokenizer.hpp"
 #include <types/splitted_string.hpp>
 
@@ -59,7 +60,6 @@ public:
 
 class SourceParser
 {
-    using TokenVector = std::vector< Token >;
     using TokenNameSet = std::unordered_set< TokenName, EnumClassHash >;
 
 public:
@@ -68,41 +68,45 @@ public:
     void parseFile(FileNode *node);
 
 private:
-    bool parseScopedName(const TokenVector &v, int offset, int end,
+    // --fast-includes, false if the file is to be parsed in full
+    bool scanIncludes(FileNode *node, const FileData &content,
+                      bool mayDeclare);
+
+    bool parseScopedName(TokenStream &v, int offset, int end,
                          SplittedPath &name);
 
-    int getIdentifierStart(const TokenVector &v, int offset) const;
-    void skipOperatorOverloadingReverse(const TokenVector &v,
-                                        int &offset) const;
-    void skipLine(const TokenVector &tokens, int &offset) const;
-    void skipUntilEndif(const TokenVector &tokens, int &offset) const;
-    bool skipTemplate(const TokenVector &v, int &offset) const;
-    bool skipTemplateReverse(const TokenVector &tokens, int &offset) const;
+    int getIdentifierStart(TokenStream &v, int offset) const;
+    void skipOperatorOverloadingReverse(TokenStream &v, int &offset) const;
+    void skipLine(TokenStream &tokens, int &offset) const;
+    void skipUntilEndif(TokenStream &tokens, int &offset) const;
+    bool skipTemplate(TokenStream &v, int &offset) const;
+    bool skipTemplateReverse(TokenStream &tokens, int &offset) const;
 
     void prepare();
-    TokenName readUntil(const TokenVector &tokens, int &offset,
+    TokenName readUntil(TokenStream &tokens, int &offset,
                         const TokenNameSet &tokenNames);
 
-    void increment(const TokenVector &tokens, int &offset,
-                   bool checkRange = false);
+    void increment(TokenStream &tokens, int &offset, bool checkRange = false);
     void increment_pp(int &offset, int n = 1) const { offset += n; }
     void decrement_pp(int &offset, int n = 1) const { offset -= n; }
 
     bool isTopLevelCB() const;
     void setNamespace();
-    void dealWithClassDeclaration(const TokenVector &tokens, int offset);
-    void parseIncludeFilename(const TokenVector &tokens, int &offset,
+    void dealWithClassDeclaration(TokenStream &tokens, int offset);
+    void parseIncludeFilename(TokenStream &tokens, int &offset,
                               IncludeDirective &dir);
-    void readPath(const TokenVector &tokens, int &offset, SplittedPath &path);
+    void readPath(TokenStream &tokens, int &offset, SplittedPath &path);
 
-    bool checkOffset(const TokenVector &tokens, int offset) const;
-    void assertOnBadRange(const TokenVector &tokens, int offset) const;
-    bool isClassToken(const TokenVector &tokens, int offset) const;
-    bool isInheritanceToken(const TokenVector &tokens, int offset) const;
+    bool checkOffset(TokenStream &tokens, int offset) const;
+    void assertOnBadRange(TokenStream &tokens, int offset) const;
+    bool isClassToken(TokenStream &tokens, int offset) const;
+    bool isInheritanceToken(TokenStream &tokens, int offset) const;
 
 private:
     const FileTree &_fileTree;
     FileNode *_node;
+    TokenStream _tokens;
+    IncludeScanner _includeScanner;
 
     ScopedName _currentNamespace;
     std::vector< ScopedName > _listUsingNamespace;
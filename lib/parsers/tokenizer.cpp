@@ -1,218 +1,187 @@
 #include "tokenizer.hpp"
 
-#include <algorithm> // for_each
+#include "char_scan.hpp"
 
-#include <cstring> // strncmp
-#include <sstream> // stringstream
-
-static decltype(auto) initSymbolTree()
-{
-    TreeNode< char > root;
-
-    auto map_size = special_symbols.size();
-    for (int i = 0; i < map_size; ++i) {
-        auto str = special_symbols[i].second;
-        root.insert(str, strlen(str));
-    }
-
-    return root;
-}
+#include <algorithm> // min
 
-static bool istextual(int ch)
-{
-    return isalpha(ch) || isdigit(ch) || ch == '_';
-}
-
-static TokenizerState new_state(int ch)
-{
-    if (istextual(ch))
-        return TokenizerState::Textual;
-    else if (isspace(ch))
-        return TokenizerState::Default;
-    else
-        return TokenizerState::Symbol;
-}
-
-static void update_state(char *p, TokenizerState &state, char *&word_start)
-{
-    state = new_state(*p);
-    word_start = p;
-}
+#include <cstring> // memcmp, strlen
+#include <sstream> // stringstream
 
 Tokenizer::Tokenizer()
-    : _n_char(0), _n_line(0), _n_token_char(0), _n_token_line(0)
+    : _p(nullptr), _end(nullptr), _linesCountedTo(nullptr), _line(0),
+      _isSkipped(false)
 {}
 
-void Tokenizer::tokenize(const SplittedPath &path)
+void Tokenizer::open(const SplittedPath &path, FileData content)
 {
-    static const auto symbolsTree = initSymbolTree();
-    std::string fname = path.jointOs();
-    _fileData = readFile(fname.c_str(), "r");
-
-    char *data = _fileData.data.get();
-    auto file_size = _fileData.size;
-    if (!data) {
-        errors() << "Failed to open the file"
-                 << '\"' + std::string(fname) + '\"';
+    _filename = path.jointOs();
+    if (content.data)
+        _fileData = std::move(content);
+    else
+        _fileData = readFile(_filename.c_str(), "r");
+
+    _p = _end = _linesCountedTo = _fileData.data.get();
+    _line = 1;
+    _isSkipped = false;
+    if (!_p) {
+        errors() << "Failed to open the file" << '\"' + _filename + '\"';
         return;
     }
+    // offsets of the tokens are 32-bit
+    if (_fileData.size > maxOffset) {
+        errors() << "warning: skip the file" << '\"' + _filename + '\"'
+                 << "of" << ntos(_fileData.size) << "bytes";
+        _isSkipped = true;
+        return;
+    }
+    _end = _p + _fileData.size;
+}
 
-    TokenizerState state = TokenizerState::Default;
-    char *word_start = nullptr;
-
-    initDebug(fname);
-
-    for (long offset = 0; offset < file_size; increment(data, offset)) {
-        auto p = data + offset;
-        int ch = *p;
-
-        switch (state) {
-        case TokenizerState::Default:
-            updateState(p, state, word_start);
-            break;
-        case TokenizerState::Textual:
-            if (istextual(ch))
-                continue;
-            emplaceToken(Token(word_start, p - word_start));
-            updateState(p, state, word_start);
+bool Tokenizer::next(Token &token)
+{
+    // a word or a symbol running to the end of the text is not a token
+    while (_p < _end) {
+        const char *p = _p;
+        switch (charClasses[*p]) {
+        case CharClass::Space:
+            _p = CharScan::skipSpaces(p + 1, _end);
             break;
-        case TokenizerState::Symbol: {
-            if (symbolsTree.find(word_start, p - word_start + 1))
-                continue;
-            if (auto tmp = symbolsTree.find(word_start, p - word_start)) {
-                while (!tmp->finite) { // fix >>= (>) case
-                    --offset;
-                    tmp = symbolsTree.find(word_start,
-                                           data + offset - word_start);
+        case CharClass::Textual: {
+            const char *word_end = CharScan::skipTextual(p + 1, _end);
+            if (word_end == _end) {
+                _p = _end;
+                return false;
+            }
+            if (!checkLength(word_end - p))
+                return false;
+            token = makeToken(key_word_table.find(p, word_end - p), p,
+                              word_end - p);
+            _p = word_end;
+            return true;
+        }
+        case CharClass::Other: {
+            const char *q = p;
+            const char *symbol_end = p;
+            TokenName name = TokenName::Undefined;
+            SymbolAutomaton::State state = SymbolAutomaton::root;
+            for (; q < _end; ++q) {
+                state = symbol_automaton.next(state, *q);
+                if (state == SymbolAutomaton::dead)
+                    break;
+                if (symbol_automaton.accepted(state) != TokenName::Undefined) {
+                    name = symbol_automaton.accepted(state);
+                    symbol_end = q + 1;
                 }
-
-                emplaceToken(Token(word_start, data + offset - word_start));
-                dealWithSpecialTokens(data, offset, file_size);
             }
-            updateState(data + offset, state, word_start);
+            if (q == _end) {
+                _p = _end;
+                return false;
+            }
+            if (q == p) { // not a symbol
+                ++_p;
+                break;
+            }
+
+            token = makeToken(name, p, symbol_end - p);
+            _p = symbol_end;
+            if (dealWithSpecialToken(token))
+                return true;
             break;
         }
-        default:
-            assert(false);
         }
     }
+    return false;
 }
 
-const Tokenizer::TokenVector &Tokenizer::tokens() const { return _tokens; }
-
-int read_string(const char *data, char qch, long max)
-{
-    for (int offset = 0; offset < max; ++offset) {
-        if (data[offset] == '\\')
-            ++offset;
-        else if (data[offset] == qch)
-            return offset;
-    }
-    assert(false);
-    return max;
-}
-
-void Tokenizer::dealWithSpecialTokens(const char *data, long &offset,
-                                      long file_size)
+bool Tokenizer::dealWithSpecialToken(Token &token)
 {
-    assert(!_tokens.empty());
-    Token &last_token = _tokens.back();
-    switch (last_token.name) {
+    switch (token.name) {
     case TokenName::SingleQuote:
     case TokenName::DoubleQuote: {
-        const char qch =
-            ((last_token.name == TokenName::SingleQuote) ? '\'' : '\"');
-        int str_len = read_string(data + offset, qch, file_size - offset);
-
-        ++last_token.lexeme;
-        last_token.length = str_len;
-        last_token.name = TokenName::String;
-
-        offset += str_len + 1;
-        break;
-    }
-    case TokenName::DoubleSlash: {
-        readUntil(data, offset, [](const char *data, long offset) {
-            return (data[offset] == '\n' && data[offset - 1] != '\\');
-        });
-        increment(data, offset);
-        _tokens.pop_back(); // skip comments
-        break;
-    }
-    case TokenName::SlashStar: {
-        readUntil(data, offset, [](const char *data, long offset) {
-            return strncmp(data + offset, "*/", 2) == 0;
-        });
-
-        increment_n(data, offset, sizeof("*/") - 1);
-        _tokens.pop_back(); // skip comments
-        break;
+        const char qch = ((token.name == TokenName::SingleQuote) ? '\'' : '\"');
+        const char *quote = CharScan::findQuote(_p, _end, qch);
+        if (!checkLength(quote - _p))
+            return false;
+
+        ++token.offset;
+        token.length = quote - _p;
+        token.name = TokenName::String;
+
+        // past the closing quote, to the end if there is none
+        _p = std::min(quote + 1, _end);
+        _linesCountedTo = _p;
+        return true;
     }
+    case TokenName::DoubleSlash:
+        // skip comments up to the line end not escaped by a backslash
+        _p = CharScan::skipLineComment(_p, _end);
+        return false;
+    case TokenName::SlashStar:
+        _p = CharScan::skipBlockComment(_p, _end);
+        return false;
     default:
-        return;
+        return true;
     }
 }
 
-void Tokenizer::increment_n(const char *data, long &offset, int n)
+bool Tokenizer::checkLength(size_t length)
 {
-    for (int i = 0; i < n; ++i)
-        increment(data, offset);
+    if (length <= maxLength)
+        return true;
+    CharScan::forEachNewline(_linesCountedTo, _p,
+                             [this](const char *) { ++_line; });
+    errors() << "warning: skip the file" << '\"' + _filename + '\"'
+             << "with a token of" << ntos(length) << "bytes on the line"
+             << ntos(_line);
+    _p = _linesCountedTo = _end;
+    _isSkipped = true;
+    return false;
 }
 
-void Tokenizer::emplaceToken(Token &&token)
+Token Tokenizer::makeToken(TokenName name, const char *p, size_t length)
 {
-    _tokens.emplace_back(std::forward< Token >(token));
-
-    Token &emplaced_token = _tokens.back();
-
-    emplaced_token.filename = _filename;
-    emplaced_token.n_line = _n_line;
-    emplaced_token.n_char = _n_char - emplaced_token.length;
-}
+    assert(length <= maxLength);
+    CharScan::forEachNewline(_linesCountedTo, p,
+                             [this](const char *) { ++_line; });
+    _linesCountedTo = p;
 
-void Tokenizer::initDebug(const std::string &fname)
-{
-    _filename = fname;
-    _n_line = 1;
-    _n_char = 1;
-    _n_token_line = 0;
-    _n_token_char = 0;
+    return Token(name, static_cast< uint32_t >(p - _fileData.data.get()),
+                 static_cast< LengthType >(length));
 }
 
-void Tokenizer::updateDebug(int ch)
-{
-    if (ch == '\n') {
-        ++_n_token_line;
-        _n_token_char = 0;
-    }
-    else {
-        ++_n_token_char;
-    }
-}
+TokenStream::TokenStream()
+    : _ring(lookback, Entry{Token(TokenName::Undefined, 0, 0), 0}),
+      _outside{Token(TokenName::Undefined, 0, 0), 0}, _count(0), _isEnd(true)
+{}
 
-void Tokenizer::updateState(char *p, TokenizerState &state, char *&word_start)
+void TokenStream::open(const SplittedPath &path, FileData content)
 {
-    update_state(p, state, word_start);
-    newTokenDebug();
+    _tokenizer.open(path, std::move(content));
+    _count = 0;
+    _isEnd = false;
 }
 
-void Tokenizer::newTokenDebug()
+bool TokenStream::has(int i)
 {
-    if (_n_token_line > 0) {
-        _n_line += _n_token_line;
-        _n_char = 1;
-    }
-    else {
-        _n_char += _n_token_char;
+    while (_count <= i && !_isEnd) {
+        Entry &entry = _ring[_count % lookback];
+        if (_tokenizer.next(entry.token)) {
+            entry.line = _tokenizer.line();
+            ++_count;
+        }
+        else {
+            _isEnd = true;
+        }
     }
-    _n_token_char = 0;
-    _n_token_line = 0;
+    return i < _count;
 }
 
-Token::Token(const char *p, LengthType size)
-    : name(TokenName::Undefined), lexeme(p), length(size)
+TokenStream::Entry &TokenStream::entry(int i)
 {
-    name = tok(lexeme, length);
+    if (i >= first() && has(i))
+        return _ring[i % lookback];
+    _outside.line = i < first() ? 0 : _tokenizer.line();
+    return _outside;
 }
 
 bool Token::isClass() const
@@ -228,61 +197,71 @@ bool Token::isInheritance() const
 
 bool Token::isKeyWord() const { return key_words.findLexeme(name) != nullptr; }
 
-bool Token::isEndif() const
+bool Tokenizer::isIdentifier(const Token &token, const char *str) const
 {
-    return name == TokenName::Identifier && str_equal(lexeme_str(), "endif");
+    return token.name == TokenName::Identifier &&
+           token.length == strlen(str) &&
+           memcmp(lexeme(token), str, token.length) == 0;
 }
 
-bool Token::isElseMacro() const
+bool Tokenizer::isEndif(const Token &token) const
 {
-    return name == TokenName::Identifier && str_equal(lexeme_str(), "else");
+    return isIdentifier(token, "endif");
 }
 
-bool Token::isIfMacro() const
+bool Tokenizer::isElseMacro(const Token &token) const
 {
-    return name == TokenName::Identifier && str_equal(lexeme_str(), "if");
+    return isIdentifier(token, "else");
 }
 
-bool Token::isIfdef() const
+bool Tokenizer::isIfMacro(const Token &token) const
 {
-    return name == TokenName::Identifier && str_equal(lexeme_str(), "ifdef");
+    return isIdentifier(token, "if");
 }
 
-bool Token::isElif() const
+bool Tokenizer::isIfdef(const Token &token) const
 {
-    return name == TokenName::Identifier && str_equal(lexeme_str(), "elif");
+    return isIdentifier(token, "ifdef");
 }
 
-std::string Token::toString() const
+bool Tokenizer::isElif(const Token &token) const
+{
+    return isIdentifier(token, "elif");
+}
+
+std::string Tokenizer::toString(const Token &token, unsigned line) const
 {
     std::string str;
-    if (name == TokenName::Identifier || name == TokenName::String)
-        str = lexeme_str();
+    if (token.name == TokenName::Identifier || token.name == TokenName::String)
+        str = lexeme_str(token);
     else
-        str = ttos(name);
+        str = ttos(token.name);
+
+    const char *lineStart = lexeme(token);
+    while (lineStart > _fileData.data.get() && lineStart[-1] != '\n')
+        --lineStart;
     std::stringstream ss;
-    ss << '\'' << str << '\'' << " file: " << filename << " line: " << n_line
-       << " offset: " << n_char;
+    ss << '\'' << str << '\'' << " file: " << _filename << " line: " << line
+       << " offset: " << lexeme(token) - lineStart + 1;
     return ss.str();
 }
 
-void Debug::printTokens(const std::vector< Token > &tokens)
+void Debug::printTokens(TokenStream &tokens)
 {
-    int line = 0;
-    std::for_each(tokens.begin(), tokens.end(), [&line](const Token &t) {
-        if (t.n_line > line) {
+    unsigned line = 0;
+    for (int i = 0; tokens.has(i); ++i) {
+        if (tokens.line(i) > line) {
             ++line;
             std::cout << std::endl;
         }
-        std::cout << strToken(t) << std::endl;
-    });
+        std::cout << strToken(tokens.tokenizer(), tokens[i]) << std::endl;
+    }
 }
 
-std::string Debug::strToken(const Token &token)
+std::string Debug::strToken(const Tokenizer &tokenizer, const Token &token)
 {
     std::stringstream ss;
-    ss << std::string(token.lexeme, token.length)
-       << " Type: " << ttos(token.name);
+    ss << tokenizer.lexeme_str(token) << " Type: " << ttos(token.name);
     return ss.str();
 }
 
@@ -5,12 +5,14 @@
 
 #include <types/splitted_string.hpp>
 
+#include <cstring>
+#include <limits>
 #include <unordered_set>
 #include <vector>
 
 using LengthType = uint16_t;
 
-enum class TokenName {
+enum class TokenName : uint8_t {
     // Unreserved name
     Identifier,
     // Special Tokens
@@ -191,7 +193,7 @@ public:
         return findTokenR(value, length, N);
     }
 
-    decltype(auto) size() const { return _size; }
+    constexpr decltype(auto) size() const { return _size; }
     constexpr const TokenPair &operator[](int i) const { return _map[i]; }
 
 private:
@@ -325,96 +327,267 @@ constexpr TokenName tok(const char *s,
 
 static_assert(tok(".") == TokenName::Dot, "tok");
 
+// Key words by a perfect hash of the length and of the first, second and
+// last characters (gperf-style); the table is checked for collisions when
+// compiled. Words of other lengths are identifiers.
+class KeyWordTable
+{
+public:
+    constexpr KeyWordTable()
+        : _names(), _lexemes(), _lengths(), _minLength(-1), _maxLength(0),
+          _isPerfect(true)
+    {
+        for (int i = 0; i < key_words.size(); ++i) {
+            const char *lexeme = key_words[i].second;
+            const LengthType length = cstr_len(lexeme);
+            const unsigned h = hash(lexeme, length);
+            if (_lexemes[h])
+                _isPerfect = false;
+            _names[h] = key_words[i].first;
+            _lexemes[h] = lexeme;
+            _lengths[h] = length;
+            if (length < _minLength)
+                _minLength = length;
+            if (length > _maxLength)
+                _maxLength = length;
+        }
+    }
+
+    constexpr bool isPerfect() const { return _isPerfect; }
+
+    TokenName find(const char *s, size_t length) const
+    {
+        if (length < _minLength || length > _maxLength)
+            return TokenName::Identifier;
+        const unsigned h = hash(s, static_cast< LengthType >(length));
+        return (_lengths[h] == length && memcmp(_lexemes[h], s, length) == 0)
+                   ? _names[h]
+                   : TokenName::Identifier;
+    }
+
+private:
+    // key words are longer than one character
+    static constexpr unsigned hash(const char *s, LengthType length)
+    {
+        return (2u * length + 3u * static_cast< unsigned char >(s[0]) +
+                5u * static_cast< unsigned char >(s[1]) +
+                5u * static_cast< unsigned char >(s[length - 1])) %
+               64;
+    }
+
+    TokenName _names[64];
+    const char *_lexemes[64];
+    LengthType _lengths[64];
+    LengthType _minLength;
+    LengthType _maxLength;
+    bool _isPerfect;
+};
+
+// Special symbols as a flat automaton over the classes of their bytes,
+// the states are the prefixes of the symbols. The longest symbol at a
+// position is the last accepting state passed (>>= vs >).
+class SymbolAutomaton
+{
+public:
+    using State = uint8_t;
+    enum : State { dead = 0, root = 1 };
+
+    constexpr SymbolAutomaton()
+        : _classes(), _next(), _names(), _classCount(1), _stateCount(2),
+          _fits(true)
+    {
+        for (int state = 0; state < 64; ++state)
+            _names[state] = TokenName::Undefined;
+        for (int i = 0; i < special_symbols.size(); ++i)
+            insert(special_symbols[i].second, special_symbols[i].first);
+    }
+
+    constexpr bool fits() const { return _fits; }
+
+    State next(State state, char ch) const
+    {
+        return _next[state][_classes[static_cast< unsigned char >(ch)]];
+    }
+    // Undefined if the state is not accepting
+    TokenName accepted(State state) const { return _names[state]; }
+
+private:
+    constexpr void insert(const char *s, TokenName name)
+    {
+        State state = root;
+        for (; *s; ++s) {
+            uint8_t &cls = _classes[static_cast< unsigned char >(*s)];
+            if (!cls) {
+                if (_classCount == 32) {
+                    _fits = false;
+                    return;
+                }
+                cls = _classCount++;
+            }
+            State &next = _next[state][cls];
+            if (next == dead) {
+                if (_stateCount == 64) {
+                    _fits = false;
+                    return;
+                }
+                next = _stateCount++;
+            }
+            state = next;
+        }
+        _names[state] = name;
+    }
+
+    // class 0 is for the bytes of no symbol, no state goes on by it
+    uint8_t _classes[256];
+    State _next[64][32];
+    TokenName _names[64];
+    uint8_t _classCount;
+    State _stateCount;
+    bool _fits;
+};
+
+constexpr KeyWordTable key_word_table;
+constexpr SymbolAutomaton symbol_automaton;
+
+static_assert(key_word_table.isPerfect(), "key word hash collision");
+static_assert(symbol_automaton.fits(), "symbol automaton is full");
+
 std::string ttos(const TokenName &t);
 
+// Position of a token in the text of its file, the text and the line
+// numbers are held by the tokenizer
 class Token
 {
 public:
-    Token(const char *p, LengthType size);
+    Token(TokenName name, uint32_t offset, LengthType length)
+        : name(name), length(length), offset(offset)
+    {
+    }
 
     TokenName name;
-    const char *lexeme;
     LengthType length;
-
-    std::string lexeme_str() const { return std::string(lexeme, length); }
-    // Debug
-    std::string filename;
-    uint16_t n_line;
-    uint16_t n_char;
+    uint32_t offset;
 
 public:
     // common methods
     bool isClass() const;
     bool isInheritance() const;
     bool isKeyWord() const;
-    bool isEndif() const;
-    bool isElseMacro() const;
-    bool isIfMacro() const;
-    bool isIfdef() const;
-    bool isElif() const;
-
-    std::string toString() const;
 };
 
-enum class TokenizerState {
-    Default,
-    Textual, // Doesn't matter if number or identifier, so just 'Textual'
-    Symbol
-};
+static_assert(sizeof(Token) == 8, "tokens of a file are stored in an array");
 
+// Produces the tokens of a file one by one
 class Tokenizer
 {
 public:
-    using TokenVector = std::vector< Token >;
     using StringSet = std::unordered_set< std::string >;
 
 public:
+    // the offsets and the lengths the tokens hold
+    static const size_t maxOffset = std::numeric_limits< uint32_t >::max();
+    static const size_t maxLength = std::numeric_limits< LengthType >::max();
+
     Tokenizer();
 
-    void tokenize(const SplittedPath &path);
+    // tokenizes content if it holds the file contents, reads the file else
+    void open(const SplittedPath &path, FileData content = FileData());
+    // false at the end of the file
+    bool next(Token &token);
+    // the file is larger than maxOffset or has a token longer than
+    // maxLength: it is reported and no more tokens are read
+    bool isSkipped() const { return _isSkipped; }
+    // of the last token: 1-based, newlines inside of the strings are not
+    // counted
+    unsigned line() const { return _line; }
+
+    // the text is valid until the next file is opened
+    const char *lexeme(const Token &token) const
+    {
+        return _fileData.data.get() + token.offset;
+    }
+    std::string lexeme_str(const Token &token) const
+    {
+        return std::string(lexeme(token), token.length);
+    }
 
-    const TokenVector &tokens() const;
+    bool isEndif(const Token &token) const;
+    bool isElseMacro(const Token &token) const;
+    bool isIfMacro(const Token &token) const;
+    bool isIfdef(const Token &token) const;
+    bool isElif(const Token &token) const;
 
-private:
-    void dealWithSpecialTokens(const char *data, long &offset, long file_size);
-    void emplaceToken(Token &&tok);
+    std::string toString(const Token &token, unsigned line) const;
 
-    void increment(const char *data, long &offset)
-    {
-        updateDebug(data[offset]);
-        ++offset;
-    }
-    void increment_n(const char *data, long &offset, int n);
+private:
+    // moves past the comment or the string started by the token,
+    // false if the token is dropped (comments)
+    bool dealWithSpecialToken(Token &token);
+    // false if the token is too long, the file is skipped then
+    bool checkLength(size_t length);
+    Token makeToken(TokenName name, const char *p, size_t length);
+    bool isIdentifier(const Token &token, const char *str) const;
 
 private:
-    TokenVector _tokens;
     FileData _fileData;
+    const char *_p;
+    const char *_end;
 
     // Debug
-    void initDebug(const std::string &fname);
-    void updateDebug(int ch);
-    void updateState(char *p, TokenizerState &state, char *&word_start);
-    void newTokenDebug();
+    std::string _filename;
+    // lines are counted up to the last token only
+    const char *_linesCountedTo;
+    unsigned _line;
+    bool _isSkipped;
+};
+
+// Tokens of a file in the order the parser reads them. They are pulled
+// from the tokenizer on demand and the last lookback tokens only are kept
+// for the backward scans of the parser (over a name, template arguments
+// or an operator); the tokens before them read as the file beginning.
+// Out of the kept tokens, before them or past the end of the file, an
+// Undefined token is read.
+class TokenStream
+{
+public:
+    enum { lookback = 4096 };
+
+    TokenStream();
 
-    template < typename TFunc >
-    void readUntil(const char *data, long &offset, TFunc f)
+    void open(const SplittedPath &path, FileData content = FileData());
+
+    // pulls the tokens up to i
+    bool has(int i);
+    // the oldest token kept
+    int first() const { return _count > lookback ? _count - lookback : 0; }
+
+    // Undefined unless first() <= i and has(i); its line is 0 before the
+    // kept tokens and the line of the last token past the end
+    const Token &operator[](int i) { return entry(i).token; }
+    unsigned line(int i) { return entry(i).line; }
+
+    const Tokenizer &tokenizer() const { return _tokenizer; }
+
+private:
+    struct Entry
     {
-        while (!f(data, offset))
-            increment(data, offset);
-    }
+        Token token;
+        unsigned line;
+    };
 
-    std::string _filename;
-    uint16_t _n_line;
-    uint16_t _n_char;
+    Entry &entry(int i);
 
-    uint16_t _n_token_line;
-    uint16_t _n_token_char;
+    Tokenizer _tokenizer;
+    std::vector< Entry > _ring;
+    Entry _outside;
+    int _count;
+    bool _isEnd;
 };
 
 namespace Debug {
 
-std::string strToken(const Token &token);
-void printTokens(const std::vector< Token > &tokens);
+std::string strToken(const Tokenizer &tokenizer, const Token &token);
+void printTokens(TokenStream &tokens);
 
 } // namespace Debug
 
@@ -0,0 +1,37 @@
+#include "resident_tree.hpp"
+#include "command_line_args.hpp"
+
+ResidentTree::ResidentTree(const CommandLineArgs &clargs) : _clargs(clargs) {}
+
+ResidentTree::~ResidentTree() {}
+
+void ResidentTree::refresh()
+{
+    std::unique_ptr< FileTree > tree(new FileTree);
+    tree->setRootPath(_clargs.rootDirectory());
+    tree->setJobs(_clargs.jobs());
+    tree->setTrustMtime(_clargs.isTrustMtime());
+    tree->setHashAlgorithm(_clargs.hashAlgorithm());
+    tree->setFastIncludes(_clargs.isFastIncludes(),
+                          _clargs.fullParseExtensions());
+
+    tree->readFiles(_clargs);
+    tree->restoreSnapshot(_clargs.ftreeDumpIn());
+    tree->calculateFileHashes();
+    tree->addIncludePaths(_clargs.includePaths());
+    tree->installExtraDependencies(_clargs.extraDeps());
+    tree->parsePhase();
+    tree->analyzePhase();
+    if (!_clargs.isNoMain())
+        tree->labelTestMain();
+
+    _tree = std::move(tree);
+}
+
+void ResidentTree::refresh(const std::vector< SplittedPath > &changedFiles)
+{
+    if (!_tree)
+        refresh();
+    else if (!changedFiles.empty())
+        _tree->update(changedFiles, _clargs);
+}
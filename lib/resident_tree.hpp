@@ -0,0 +1,35 @@
+#ifndef RESIDENT_TREE_HPP
+#define RESIDENT_TREE_HPP
+
+#include "types/file_tree.hpp"
+
+#include <memory>
+#include <vector>
+
+class CommandLineArgs;
+
+// File tree kept in memory by the long running modes (--serve, --watch).
+// It is built once; then the changes are applied to it in place, and only
+// the changed files are read, parsed and analyzed again.
+class ResidentTree
+{
+public:
+    explicit ResidentTree(const CommandLineArgs &clargs);
+    ~ResidentTree();
+
+    // builds the tree from the dump given by --ftree-in
+    void refresh();
+    // applies the changes of the given files, relative to the root,
+    // see FileTree::update()
+    void refresh(const std::vector< SplittedPath > &changedFiles);
+
+    bool isBuilt() const { return _tree != nullptr; }
+    FileTree &tree() { return *_tree; }
+    const FileTree &tree() const { return *_tree; }
+
+private:
+    const CommandLineArgs &_clargs;
+    std::unique_ptr< FileTree > _tree;
+};
+
+#endif // RESIDENT_TREE_HPP
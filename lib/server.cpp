@@ -0,0 +1,206 @@
+#include "server.hpp"
+#include "command_line_args.hpp"
+#include "directoryreader.hpp"
+#include "extensions/error_reporter.hpp"
+
+#include <sstream>
+
+#ifndef WIN32
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#endif
+
+Server::Server(const CommandLineArgs &clargs)
+    : _clargs(clargs), _resident(clargs),
+      _ignored(clargs.ignoredSubstrings()),
+      _sourceExtensions(DirectoryReader::_sourceFileExtensions)
+{
+}
+
+Server::~Server() {}
+
+std::vector< SplittedPath >
+Server::staleFiles(const std::vector< SplittedPath > &paths) const
+{
+    const FileTree &tree = _resident.tree();
+    std::vector< SplittedPath > stale;
+    for (const SplittedPath &path : paths) {
+        const SplittedPath filePath = tree.rootPath() + path;
+        FileStat st;
+        const bool exists = file_stat(filePath.c_str(), st);
+
+        const FileNode *node = tree.searchInRoot(path);
+        if (!node || !node->isRegularFile()) {
+            // added, unless the tree wouldn't read it anyway
+            if (exists && isReadable(filePath))
+                stale.push_back(path);
+            continue;
+        }
+        const FileStat &known = node->record()._stat;
+        if (!exists || !known.isKnown() || st != known)
+            stale.push_back(path);
+    }
+    return stale;
+}
+
+bool Server::isReadable(const SplittedPath &filePath) const
+{
+    return !_ignored.matches(filePath.jointUnix()) &&
+           _sourceExtensions.matches(filePath.last().str());
+}
+
+std::string Server::answer(const std::string &request)
+{
+    std::vector< SplittedPath > paths;
+    std::istringstream is(request);
+    std::string line;
+    while (std::getline(is, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (!line.empty())
+            paths.push_back(SplittedPath(line, SplittedPath::unixSep()));
+    }
+
+    const std::vector< SplittedPath > stale = staleFiles(paths);
+    if (!stale.empty())
+        _resident.refresh(stale);
+
+    FileTree &tree = _resident.tree();
+    std::vector< FileNode * > changedFiles;
+    for (const SplittedPath &path : paths) {
+        FileNode *node = tree.searchInRoot(path);
+        if (node && node->isRegularFile())
+            changedFiles.push_back(node);
+    }
+    tree.installAffectedFiles(changedFiles);
+
+    std::ostringstream os;
+    tree.writeFiles(os, &FileNode::isAffectedTest);
+    return os.str();
+}
+
+#ifdef WIN32
+int Server::run()
+{
+    errors() << "error: --serve needs UNIX sockets";
+    return 1;
+}
+#else // POSIX
+static bool readRequest(int fd, std::string &request)
+{
+    char buffer[4096];
+    for (;;) {
+        const ssize_t count = read(fd, buffer, sizeof(buffer));
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0)
+            return false;
+        if (count == 0)
+            return true; // the client shut down writing
+        request.append(buffer, count);
+
+        // or ended the query with an empty line
+        const size_t size = request.size();
+        if ((size == 1 && request[0] == '\n') ||
+            (size >= 2 && request.compare(size - 2, 2, "\n\n") == 0))
+            return true;
+    }
+}
+
+static bool writeResponse(int fd, const std::string &response)
+{
+    const char *data = response.data();
+    size_t left = response.size();
+    while (left) {
+        const ssize_t count = write(fd, data, left);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count < 0)
+            return false;
+        data += count;
+        left -= count;
+    }
+    return true;
+}
+
+// the path may be taken by a socket left by a server which is gone only
+static bool releaseSocketPath(const sockaddr_un &address)
+{
+    struct stat st;
+    if (lstat(address.sun_path, &st) < 0)
+        return errno == ENOENT;
+
+    const int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe < 0)
+        return false;
+    const bool isRefused =
+        connect(probe, reinterpret_cast< const sockaddr * >(&address),
+                sizeof(address)) < 0 &&
+        errno == ECONNREFUSED;
+    close(probe);
+    if (!isRefused || !S_ISSOCK(st.st_mode))
+        return false;
+    return unlink(address.sun_path) == 0;
+}
+
+int Server::run()
+{
+    const std::string socketPath = _clargs.serveSocket().jointOs();
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        errors() << "error: socket path" << socketPath << "is too long";
+        return 1;
+    }
+    strcpy(address.sun_path, socketPath.c_str());
+
+    if (!releaseSocketPath(address)) {
+        errors() << "error:" << socketPath << "is already serving or taken";
+        return 1;
+    }
+
+    _resident.refresh();
+
+    const int listening = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listening < 0) {
+        errors() << "error: socket():" << strerror(errno);
+        return 1;
+    }
+    if (bind(listening, reinterpret_cast< sockaddr * >(&address),
+             sizeof(address)) < 0 ||
+        listen(listening, SOMAXCONN) < 0) {
+        errors() << "error: can't listen on" << socketPath << ":"
+                 << strerror(errno);
+        close(listening);
+        return 1;
+    }
+    // clients closing early must not kill the server
+    signal(SIGPIPE, SIG_IGN);
+
+    if (_clargs.verbal())
+        std::cout << "serving on " << socketPath << std::endl;
+
+    for (;;) {
+        const int client = accept(listening, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            errors() << "error: accept():" << strerror(errno);
+            break;
+        }
+        std::string request;
+        if (readRequest(client, request))
+            writeResponse(client, answer(request));
+        close(client);
+    }
+    close(listening);
+    unlink(socketPath.c_str());
+    return 1;
+}
+#endif
@@ -0,0 +1,45 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include "extensions/help_functions.hpp"
+#include "extensions/string_matchers.hpp"
+#include "resident_tree.hpp"
+
+#include <string>
+#include <vector>
+
+class CommandLineArgs;
+
+// Keeps the file tree in memory between queries over a UNIX socket.
+// A query lists file paths relative to the root, one per line, and ends
+// with an empty line or when the client shuts down writing; the answer
+// lists the tests affected by these files, as tests_affected.txt does.
+// The tree is updated in place when some queried file changed since it
+// was built, only the changed files are read and parsed again. A socket
+// path another server answers on is left alone.
+class Server
+{
+public:
+    explicit Server(const CommandLineArgs &clargs);
+    ~Server();
+
+    // serves until the process is killed
+    int run();
+
+private:
+    // the queried files that changed since the tree was built
+    std::vector< SplittedPath >
+    staleFiles(const std::vector< SplittedPath > &paths) const;
+    // whether a new file would be read into the tree as a source file
+    bool isReadable(const SplittedPath &filePath) const;
+    std::string answer(const std::string &request);
+
+    const CommandLineArgs &_clargs;
+    ResidentTree _resident;
+
+    // the filters of DirectoryReader
+    SubstringMatcher _ignored;
+    ExtensionMatcher _sourceExtensions;
+};
+
+#endif // SERVER_HPP
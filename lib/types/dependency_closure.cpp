@@ -0,0 +1,218 @@
+#include "types/dependency_closure.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace {
+
+using Index = DependencyClosure::Index;
+
+const Index noIndex = UINT32_MAX;
+
+// counting sort of values by keys in [0, keyCount): values of the key k are
+// result[begin[k]] .. result[begin[k + 1] - 1]
+void groupByKeys(size_t keyCount, const std::vector< Index > &keys,
+                 const std::vector< Index > &values,
+                 std::vector< Index > &begin, std::vector< Index > &result)
+{
+    begin.assign(keyCount + 1, 0);
+    for (Index key : keys)
+        ++begin[key + 1];
+    for (size_t k = 0; k < keyCount; ++k)
+        begin[k + 1] += begin[k];
+
+    std::vector< Index > next(begin.begin(), begin.end() - 1);
+    result.resize(values.size());
+    for (size_t i = 0; i < values.size(); ++i)
+        result[next[keys[i]]++] = values[i];
+}
+
+} // namespace
+
+DependencyClosure::DependencyClosure(const std::vector< FileNode * > &sources)
+    : _componentCount(0)
+{
+    for (FileNode *source : sources)
+        indexOf(source);
+    _sourceCount = static_cast< Index >(_nodes.size());
+
+    // _nodes grows while it is walked, so every reachable node is visited
+    for (size_t i = 0; i < _nodes.size(); ++i) {
+        _edgesBegin.push_back(static_cast< Index >(_edges.size()));
+        for (FileNode *dep : _nodes[i]->_setExplicitDependencies)
+            _edges.push_back(indexOf(dep));
+    }
+    _edgesBegin.push_back(static_cast< Index >(_edges.size()));
+
+    findComponents();
+    connectComponents();
+    buildClosures();
+}
+
+std::vector< FileNode * >
+DependencyClosure::dependencies(const FileNode *node) const
+{
+    const Index index = find(node);
+    if (index >= _sourceCount)
+        return std::vector< FileNode * >();
+    return nodes(_dependencies[_component[index]]);
+}
+
+std::vector< FileNode * >
+DependencyClosure::dependentBy(const FileNode *node) const
+{
+    const Index index = find(node);
+    if (index == noIndex)
+        return std::vector< FileNode * >();
+    return nodes(_dependentBy[_component[index]]);
+}
+
+DependencyClosure::Index DependencyClosure::indexOf(FileNode *node)
+{
+    auto inserted =
+        _indices.emplace(node, static_cast< Index >(_nodes.size()));
+    if (inserted.second)
+        _nodes.push_back(node);
+    return inserted.first->second;
+}
+
+DependencyClosure::Index DependencyClosure::find(const FileNode *node) const
+{
+    auto it = _indices.find(node);
+    return it != _indices.end() ? it->second : noIndex;
+}
+
+void DependencyClosure::findComponents()
+{
+    // iterative, include chains may be deeper than the call stack allows
+    struct Frame
+    {
+        Index node;
+        Index nextEdge;
+    };
+
+    const size_t count = _nodes.size();
+    std::vector< Index > order(count, noIndex);
+    std::vector< Index > lowLink(count);
+    std::vector< Index > stack;
+    std::vector< Frame > calls;
+    Index visited = 0;
+
+    _component.assign(count, noIndex);
+
+    auto visit = [&](Index node) {
+        order[node] = lowLink[node] = visited++;
+        stack.push_back(node);
+        calls.push_back(Frame{node, _edgesBegin[node]});
+    };
+
+    for (Index root = 0; root < count; ++root) {
+        if (order[root] != noIndex)
+            continue;
+        visit(root);
+
+        while (!calls.empty()) {
+            const Index node = calls.back().node;
+            if (calls.back().nextEdge < _edgesBegin[node + 1]) {
+                const Index dep = _edges[calls.back().nextEdge++];
+                if (order[dep] == noIndex)
+                    visit(dep);
+                else if (_component[dep] == noIndex) // still on the stack
+                    lowLink[node] = std::min(lowLink[node], order[dep]);
+                continue;
+            }
+
+            calls.pop_back();
+            if (!calls.empty()) {
+                Index &parentLowLink = lowLink[calls.back().node];
+                parentLowLink = std::min(parentLowLink, lowLink[node]);
+            }
+
+            if (lowLink[node] != order[node])
+                continue;
+            // node is the root of a component
+            Index member;
+            do {
+                member = stack.back();
+                stack.pop_back();
+                _component[member] = _componentCount;
+            } while (member != node);
+            ++_componentCount;
+        }
+    }
+}
+
+void DependencyClosure::connectComponents()
+{
+    std::vector< Index > nodes(_nodes.size());
+    for (Index i = 0; i < _nodes.size(); ++i)
+        nodes[i] = i;
+    groupByKeys(_componentCount, _component, nodes, _membersBegin, _members);
+
+    // successors of the components without duplicates
+    std::vector< Index > lastSeenFrom(_componentCount, noIndex);
+    std::vector< Index > from;
+    for (Index component = 0; component < _componentCount; ++component) {
+        lastSeenFrom[component] = component;
+        _successorsBegin.push_back(static_cast< Index >(_successors.size()));
+
+        for (Index m = _membersBegin[component];
+             m < _membersBegin[component + 1]; ++m) {
+            const Index node = _members[m];
+            for (Index e = _edgesBegin[node]; e < _edgesBegin[node + 1]; ++e) {
+                const Index successor = _component[_edges[e]];
+                if (lastSeenFrom[successor] == component)
+                    continue;
+                lastSeenFrom[successor] = component;
+                _successors.push_back(successor);
+                from.push_back(component);
+            }
+        }
+    }
+    _successorsBegin.push_back(static_cast< Index >(_successors.size()));
+
+    groupByKeys(_componentCount, _successors, from, _predecessorsBegin,
+                _predecessors);
+}
+
+void DependencyClosure::buildClosures()
+{
+    _dependencies.resize(_componentCount);
+    _dependentBy.resize(_componentCount);
+
+    // successors are closed already, see the numbering
+    DynamicBitset closure(_nodes.size());
+    for (Index component = 0; component < _componentCount; ++component) {
+        closure.clear();
+        for (Index m = _membersBegin[component];
+             m < _membersBegin[component + 1]; ++m)
+            closure.set(_members[m]);
+        for (Index s = _successorsBegin[component];
+             s < _successorsBegin[component + 1]; ++s)
+            _dependencies[_successors[s]].orInto(closure);
+        _dependencies[component] = CompressedBitset(closure);
+    }
+
+    // and predecessors in the reverse order
+    DynamicBitset dependentBy(_sourceCount);
+    for (Index component = _componentCount; component-- > 0;) {
+        dependentBy.clear();
+        for (Index m = _membersBegin[component];
+             m < _membersBegin[component + 1]; ++m) {
+            if (_members[m] < _sourceCount)
+                dependentBy.set(_members[m]);
+        }
+        for (Index p = _predecessorsBegin[component];
+             p < _predecessorsBegin[component + 1]; ++p)
+            _dependentBy[_predecessors[p]].orInto(dependentBy);
+        _dependentBy[component] = CompressedBitset(dependentBy);
+    }
+}
+
+std::vector< FileNode * >
+DependencyClosure::nodes(const CompressedBitset &indices) const
+{
+    std::vector< FileNode * > result;
+    indices.forEach([&](Index i) { result.push_back(_nodes[i]); });
+    return result;
+}
@@ -0,0 +1,70 @@
+#ifndef DEPENDENCY_CLOSURE_HPP
+#define DEPENDENCY_CLOSURE_HPP
+
+#include "extensions/bitset.hpp"
+#include "types/file_tree.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Transitive closure of the explicit dependencies of the source files.
+// Files reachable from each other (include cycles, a header and its
+// implementation) have the same closure, so strongly connected components
+// are found first (Tarjan) and the closures are built once per component
+// from the closures of the neighbouring components.
+// Files get dense indices, source files go first, and the closures are
+// stored as compressed bitsets of the indices.
+class DependencyClosure
+{
+public:
+    using Index = CompressedBitset::Index;
+
+    explicit DependencyClosure(const std::vector< FileNode * > &sources);
+
+    // files a source file depends on, including the file itself;
+    // empty for other files
+    std::vector< FileNode * > dependencies(const FileNode *node) const;
+    // source files depending on the file, including the file itself
+    std::vector< FileNode * > dependentBy(const FileNode *node) const;
+
+private:
+    Index indexOf(FileNode *node);
+    Index find(const FileNode *node) const;
+
+    void findComponents();
+    void connectComponents();
+    void buildClosures();
+
+    std::vector< FileNode * > nodes(const CompressedBitset &indices) const;
+
+    // files reachable from the source files, in discovery order
+    std::vector< FileNode * > _nodes;
+    std::unordered_map< const FileNode *, Index > _indices;
+    Index _sourceCount;
+
+    // explicit dependencies of _nodes[i] are
+    // _edges[_edgesBegin[i]] .. _edges[_edgesBegin[i + 1] - 1]
+    std::vector< Index > _edgesBegin;
+    std::vector< Index > _edges;
+
+    // components are numbered in reverse topological order,
+    // a component goes after the components it depends on
+    std::vector< Index > _component;
+    Index _componentCount;
+
+    // the same layout as the edges of the files
+    std::vector< Index > _membersBegin;
+    std::vector< Index > _members;
+    std::vector< Index > _successorsBegin;
+    std::vector< Index > _successors;
+    std::vector< Index > _predecessorsBegin;
+    std::vector< Index > _predecessors;
+
+    // per component: files the members depend on,
+    // source files depending on the members
+    std::vector< CompressedBitset > _dependencies;
+    std::vector< CompressedBitset > _dependentBy;
+};
+
+#endif // DEPENDENCY_CLOSURE_HPP
@@ -1,7 +1,9 @@
 #include "types/file_tree.hpp"
+#include "types/dependency_closure.hpp"
 
 #include "extensions/help_functions.hpp"
 #include "extensions/flatbuffers_extensions.hpp"
+#include "extensions/parallel.hpp"
 
 #include "command_line_args.hpp"
 #include "directoryreader.hpp"
@@ -12,6 +14,7 @@
 
 #include <external/flatbuffers/flatbuffers.h>
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <fstream>
@@ -28,8 +31,10 @@ static void test_dependency_dependentyBy_match(FileNode *fnode)
 {
     if (fnode == nullptr)
         return;
-    for (auto &&file : fnode->_setDependencies) {
-        if (file->_setDependentBy.find(fnode) == file->_setDependentBy.end()) {
+    for (auto &&file : fnode->dependencies()) {
+        const auto dependentBy = file->dependentBy();
+        if (std::find(dependentBy.begin(), dependentBy.end(), fnode) ==
+            dependentBy.end()) {
             std::cerr << "ERROR: FILE " << file->fullPath().joint() << " FNODE "
                       << fnode->fullPath().joint() << std::endl;
             file->_fileTree.print();
@@ -49,7 +54,7 @@ test_dependencies_recursion_h(FileNode *depNode,
 {
     assert(depNode);
 
-    for (auto &&dep : depNode->_setDependencies) {
+    for (auto &&dep : depNode->dependencies()) {
         assert(totalDependencies.find(dep) != totalDependencies.end());
 
         // test is recursive also
@@ -64,12 +69,13 @@ test_dependencies_recursion_h(FileNode *depNode,
 static void test_dependencies_recursion(FileNode *fnode)
 {
     assert(fnode);
-    const auto &deps = fnode->_setDependencies;
+    const auto dependencies = fnode->dependencies();
+    const FileNode::SetFileNode deps(dependencies.begin(), dependencies.end());
 
     std::unordered_set< FileNode * > testedNodes;
     testedNodes.insert(fnode);
 
-    for (auto &&file : fnode->_setDependencies)
+    for (auto &&file : dependencies)
         test_dependencies_recursion_h(file, deps, testedNodes);
 
     for (auto &&child : fnode->childs())
@@ -95,29 +101,129 @@ void test_analyse_phase(FileTree &tree)
 } // namespace Debug
 
 FileRecord::FileRecord(const SplittedPath &path, Type type)
-    : _path(path), _type(type), _isHashValid(false)
+    : _path(path), _type(type), _isHashValid(false),
+      _id(noId), _unchangedSnapshot(nullptr)
 {
     _path.setUnixSeparator();
 }
 
-void FileRecord::calculateHash(const SplittedPath &dir_base)
+// Files modified this close to the hashing may be changed again without
+// changing their stat(), so their stat isn't remembered
+static const uint64_t racyWindowNs = 2000000000ull;
+
+static FileStat snapshotStat(const LazyUT::FileRecord &snapshot)
 {
-    auto fileData = readBinaryFile((dir_base + _path).c_str());
+    FileStat st;
+    st.mtimeNs = snapshot.mtime_ns();
+    st.size = snapshot.size();
+    st.inode = snapshot.inode();
+    return st;
+}
+
+static bool isSnapshotHash(const LazyUT::FileRecord &snapshot,
+                           const ContentHasher::HashArray &hash)
+{
+    const auto *snapshotHash = snapshot.md5();
+    return snapshotHash && snapshotHash->size() == ContentHasher::hashSize &&
+           compareHashArrays(snapshotHash->data(), hash);
+}
+
+void FileRecord::calculateHash(const SplittedPath &dir_base,
+                               const HashParams &params,
+                               const LazyUT::FileRecord *snapshot,
+                               bool keepContent)
+{
+    if (snapshot)
+        _id = snapshot->id();
+
+    const SplittedPath filePath = dir_base + _path;
+    if (file_stat(filePath.c_str(), _stat)) {
+        const auto *snapshotHash = snapshot ? snapshot->md5() : nullptr;
+        if (params.trustStat && snapshotHash &&
+            snapshotHash->size() == ContentHasher::hashSize &&
+            snapshotStat(*snapshot).isKnown() &&
+            snapshotStat(*snapshot) == _stat) {
+            // file wasn't touched since the previous run, don't read it
+            copyHashArray(_hashArray, snapshotHash->data());
+            _isHashValid = true;
+            _unchangedSnapshot = snapshot;
+            return;
+        }
+        if (_stat.mtimeNs + racyWindowNs > params.racyTimeNs)
+            _stat.clear();
+    }
+    else {
+        _stat.clear();
+    }
+
+    auto fileData = readBinaryFile(filePath.c_str());
     char *data = fileData.data.get();
     if (!data) {
         char buff[1000];
         snprintf(buff, sizeof(buff),
                  "LazyUT: Error: File \"%s\" can not be opened",
-                 (dir_base + _path).c_str());
+                 filePath.c_str());
         errors() << std::string(buff);
 
         //        assert(false);
         return;
     }
-    MD5 md5((unsigned char *)data, fileData.size);
-    md5.copyResultTo(_hashArray);
+    params.hasher->hash(data, fileData.size, _hashArray);
+
+    _isHashValid = true;
+
+    if (snapshot && isSnapshotHash(*snapshot, _hashArray))
+        _unchangedSnapshot = snapshot;
+    else if (keepContent) // unmodified files aren't parsed
+        _content = std::move(fileData);
+}
 
+bool FileRecord::restoreHash(const LazyUT::FileRecord &snapshot)
+{
+    _id = snapshot.id();
+    const auto *snapshotHash = snapshot.md5();
+    if (!snapshotHash || snapshotHash->size() != ContentHasher::hashSize)
+        return false;
+
+    copyHashArray(_hashArray, snapshotHash->data());
     _isHashValid = true;
+    // the stat the contents had then, the next --trust-mtime run
+    // reads the file if it doesn't match
+    _stat = snapshotStat(snapshot);
+    _unchangedSnapshot = &snapshot;
+    return true;
+}
+
+void FileRecord::restoreParsedData()
+{
+    assert(_unchangedSnapshot);
+    FileTreeSnapshot::restoreParsedData(*_unchangedSnapshot, *this);
+    _unchangedSnapshot = nullptr;
+}
+
+void FileRecord::clearParsedData()
+{
+    _listIncludes.clear();
+    _setImplements.clear();
+    _setClassDecl.clear();
+    _setFuncDecl.clear();
+    _setInheritances.clear();
+    _listUsingNamespace.clear();
+}
+
+void FileRecord::clearAnalyzedData()
+{
+    _setFuncImplFiles.clear();
+    _setClassImplFiles.clear();
+    _setBaseClassFiles.clear();
+    _setImplementFiles.clear();
+}
+
+FileData FileRecord::takeContent()
+{
+    FileData result = std::move(_content);
+    _content = FileData();
+    return result;
 }
 
 void FileRecord::setHash(const unsigned char *hash)
@@ -141,20 +247,10 @@ std::string FileRecord::hashHex() const
     return std::string(buf);
 }
 
-void FileRecord::swapParsedData(FileRecord &record)
-{
-    _listIncludes.swap(record._listIncludes);
-    _setImplements.swap(record._setImplements);
-    _setClassDecl.swap(record._setClassDecl);
-    _setFuncDecl.swap(record._setFuncDecl);
-    _setInheritances.swap(record._setInheritances);
-    _listUsingNamespace.swap(record._listUsingNamespace);
-}
-
 FileNode::FileNode(const SplittedPath &path, FileRecord::Type type,
                    FileTree &fileTree)
-    : _record(path, type), _parent(nullptr), _visited(false),
-      _fileTree(fileTree), _flags(Flags::Nothing)
+    : _record(path, type), _parent(nullptr), _fileTree(fileTree),
+      _flags(Flags::Nothing)
 {
 }
 
@@ -173,6 +269,18 @@ void FileNode::addChild(FileNode *child)
 
     child->setParent(this);
     _childs.push_back(child);
+
+    // a linear search is faster for the most of the directories
+    static const size_t indexedChildCount = 64;
+    if (_childIndex) {
+        _childIndex->emplace(child->fname().id(), child);
+    }
+    else if (_childs.size() > indexedChildCount) {
+        _childIndex.reset(new std::unordered_map< SymbolTable::Id,
+                                                  FileNode * >);
+        for (FileNode *indexed : _childs)
+            _childIndex->emplace(indexed->fname().id(), indexed);
+    }
 }
 
 FileNode *FileNode::findOrNewChild(const HashedFileName &hfname,
@@ -181,15 +289,21 @@ FileNode *FileNode::findOrNewChild(const HashedFileName &hfname,
     if (FileNode *foundChild = findChild(hfname))
         return foundChild;
     // not found, create new one
-    FileNode *newChild;
+    return newChild(hfname, type);
+}
+
+FileNode *FileNode::newChild(const HashedFileName &hfname,
+                             FileRecord::Type type)
+{
+    FileNode *child;
     if (parent())
-        newChild = new FileNode(_record._path + hfname, type, _fileTree);
+        child = new FileNode(_record._path + hfname, type, _fileTree);
     else
-        newChild = new FileNode(SplittedPath(hfname, SplittedPath::unixSep()),
-                                type, _fileTree);
-    addChild(newChild);
+        child = new FileNode(SplittedPath(hfname, SplittedPath::unixSep()),
+                             type, _fileTree);
+    addChild(child);
 
-    return newChild;
+    return child;
 }
 
 static void remove_one(std::vector< FileNode * > &container, FileNode *value)
@@ -205,6 +319,8 @@ void FileNode::removeChild(FileNode *child)
     child->setParent(nullptr);
 
     remove_one(_childs, child);
+    if (_childIndex)
+        _childIndex->erase(child->fname().id());
 }
 
 void FileNode::setParent(FileNode *parent) { _parent = parent; }
@@ -214,6 +330,12 @@ SplittedPath FileNode::fullPath() const
     return _fileTree.rootPath() + path();
 }
 
+void FileNode::cachePath() const
+{
+    path().joint();
+    path().splitted();
+}
+
 std::string FileNode::relativeName(const SplittedPath &base) const
 {
     return relative_path(fullPath(), base).joint();
@@ -296,7 +418,7 @@ void FileNode::printDependencies(int indent) const
 {
     std::string strIndents = makeIndents(indent, 2);
 
-    for (auto &&file : _setDependencies) {
+    for (auto &&file : dependencies()) {
         if (file == this)
             continue; // don't print the file itself
         std::cout << strIndents << string("dependecy: ") << file->name()
@@ -308,7 +430,7 @@ void FileNode::printDependentBy(int indent) const
 {
     std::string strIndents = makeIndents(indent, 2);
 
-    for (auto &&file : _setDependentBy) {
+    for (auto &&file : dependentBy()) {
         if (file == this)
             continue; // don't print the file itself
         std::cout << strIndents << string("dependent by: ") << file->name()
@@ -356,11 +478,27 @@ void FileNode::destroy()
 
 void FileNode::installIncludes()
 {
+    if (!hasResolvedIncludes())
+        resolveIncludes();
+    for (FileNode *includedFile : _includedFiles)
+        addExplicitDep(includedFile);
+}
+
+void FileNode::resolveIncludes()
+{
+    _includedFiles.clear();
     for (auto &include_directive : _record._listIncludes) {
         if (FileNode *includedFile =
                 _fileTree.searchIncludedFile(include_directive, this))
-            addExplicitDep(includedFile);
+            _includedFiles.push_back(includedFile);
     }
+    setResolvedIncludes();
+}
+
+void FileNode::resetIncludes()
+{
+    _includedFiles.clear();
+    _flags &= ~Flags::ResolvedIncludes;
 }
 
 void FileNode::installInheritances()
@@ -379,26 +517,6 @@ void FileNode::installImplements()
     }
 }
 
-void FileNode::installDependenciesR(FileNode *node)
-{
-    if (node->_visited)
-        return;
-    node->_visited = true;
-
-    const SetFileNode &nodeDeps = node->_setDependencies;
-    const SetFileNode &nodeExplicitDeps = node->_setExplicitDependencies;
-
-    if (!nodeDeps.empty()) {
-        addDependencies(nodeDeps);
-        return;
-    }
-
-    addDependencies(nodeExplicitDeps);
-
-    for (FileNode *explDepsNode : nodeExplicitDeps)
-        installDependenciesR(explDepsNode);
-}
-
 void FileNode::initExplicitDeps()
 {
     installImplements();
@@ -406,17 +524,31 @@ void FileNode::initExplicitDeps()
     installInheritances();
 }
 
-void FileNode::installDependencies()
+static void removeExplicitDep(FileNode *file, FileNode *dependency)
 {
-    _fileTree.clearVisitedR();
-
-    installDependenciesR(this);
-
-    // File allways depends on himself
-    addDependency(this);
+    file->_setExplicitDependencies.erase(dependency);
+    dependency->_setExplicitDependendentBy.erase(file);
 }
 
-void FileNode::clearVisited() { _visited = false; }
+void FileNode::removeExplicitDeps(SetFileNode &ends)
+{
+    for (auto &file_path : _record._setImplementFiles) {
+        if (FileNode *implementedFile = _fileTree.searchInRoot(file_path)) {
+            removeExplicitDep(implementedFile, this);
+            ends.insert(implementedFile);
+        }
+    }
+    for (FileNode *includedFile : _includedFiles) {
+        removeExplicitDep(this, includedFile);
+        ends.insert(includedFile);
+    }
+    for (auto &file_path : _record._setBaseClassFiles) {
+        if (FileNode *baseClassFile = _fileTree.searchInRoot(file_path)) {
+            removeExplicitDep(this, baseClassFile);
+            ends.insert(baseClassFile);
+        }
+    }
+}
 
 FileNode *FileNode::search(const SplittedPath &path)
 {
@@ -429,20 +561,16 @@ FileNode *FileNode::search(const SplittedPath &path)
     return current_dir;
 }
 
-void FileNode::addDependency(FileNode *node)
+FileNode::ListFileNode FileNode::dependencies() const
 {
-    _setDependencies.insert(node);
-    node->_setDependentBy.insert(this);
+    return _fileTree.dependencyClosure().dependencies(this);
 }
 
-void FileNode::addDependencies(const FileNode::SetFileNode &nodes)
+FileNode::ListFileNode FileNode::dependentBy() const
 {
-    for (FileNode *node : nodes)
-        addDependency(node);
+    return _fileTree.dependencyClosure().dependentBy(this);
 }
 
-void FileNode::addDependentBy(FileNode *node) { node->addDependency(this); }
-
 void FileNode::addExplicitDep(FileNode *includedNode)
 {
     assert(includedNode);
@@ -456,12 +584,6 @@ void FileNode::addExplicitDepBy(FileNode *implementedNode)
     implementedNode->addExplicitDep(this);
 }
 
-void FileNode::swapParsedData(FileNode *file)
-{
-    assert(file);
-    _record.swapParsedData(file->_record);
-}
-
 void FileNode::setSourceFile()
 {
     if (isSourceFile())
@@ -470,24 +592,6 @@ void FileNode::setSourceFile()
     _fileTree._vectorSourceFile.push_back(this);
 }
 
-bool FileNode::isAffected() const
-{
-    // if some dependency is affected then this is affected too
-    // (this uses affected)
-    for (auto &&dep : _setDependencies) {
-        if (dep->isThisAffected())
-            return true;
-    }
-    // if some dependent by is affected then this is affected too
-    // (affected uses this)
-    for (auto &&dep : _setDependentBy) {
-        if (dep->isThisAffected())
-            return true;
-    }
-
-    return false;
-}
-
 std::vector< FileNode * > FileNode::getFiles() const
 {
     std::vector< FileNode * > vfs;
@@ -505,7 +609,8 @@ std::vector< FileNode * > FileNode::getFiles() const
 void FileNode::calculateHash()
 {
     if (isRegularFile())
-        record().calculateHash(_fileTree.rootPath());
+        record().calculateHash(_fileTree.rootPath(),
+                               {&_fileTree.hasher(), false, current_time_ns()});
 }
 
 void FileNode::removeEmptySubdirectories()
@@ -513,10 +618,13 @@ void FileNode::removeEmptySubdirectories()
     FileNode::FileNodeIterator it(_childs.begin());
 
     while (it != _childs.end()) {
-        if ((*it)->hasRegularFiles())
+        if ((*it)->hasRegularFiles()) {
             ++it;
-        else
-            it = _childs.erase(it);
+            continue;
+        }
+        if (_childIndex)
+            _childIndex->erase((*it)->fname().id());
+        it = _childs.erase(it);
     }
 }
 
@@ -542,9 +650,16 @@ static void append(T &lhs, const T &rhs)
 
 FileNode *FileNode::findChild(const HashedFileName &hfname) const
 {
-    for (auto child : _childs) {
-        if (child->fname() == hfname)
-            return child;
+    if (_childIndex) {
+        auto it = _childIndex->find(hfname.id());
+        if (it != _childIndex->end())
+            return it->second;
+    }
+    else {
+        for (auto child : _childs) {
+            if (child->fname() == hfname)
+                return child;
+        }
     }
     if (hfname.isDotDot())
         return _parent;
@@ -553,15 +668,24 @@ FileNode *FileNode::findChild(const HashedFileName &hfname) const
     return nullptr;
 }
 
-FileTree::FileTree() : _rootDirectoryNode(nullptr), _srcParser(*this)
+FileTree::FileTree()
+    : _rootDirectoryNode(nullptr), _jobs(1), _trustMtime(false),
+      _fastIncludes(false), _isFullParseLimited(false),
+      _isChangesKnown(false),
+      _hashAlgorithm(ContentHasher::defaultAlgorithm), _nextFileId(1)
 {
     clean();
 }
 
+FileTree::~FileTree() {}
+
 void FileTree::clean()
 {
     _state = Clean;
     _rootPath = SplittedPath();
+    _dependencyClosure.reset();
+    _classDecls.reset();
+    _funcDecls.reset();
     updateRoot();
 }
 
@@ -572,10 +696,42 @@ void FileTree::removeEmptyDirectories()
     _state = Filtered;
 }
 
+// Contents of the files to parse are kept after hashing, at most this much
+static const size_t contentLeaseLimit = 256 * 1024 * 1024;
+
 void FileTree::calculateFileHashes()
 {
     assert(_state == Filtered);
-    recursiveCall(*_rootDirectoryNode, &FileNode::calculateHash);
+    const std::vector< FileNode * > files = _rootDirectoryNode->getFiles();
+
+    // every record is hashed by exactly one worker, so the result doesn't
+    // depend on the number of jobs. Snapshot records tell which files
+    // will be parsed and, with --trust-mtime, give the hash of untouched files
+    const FileRecord::HashParams params = {&hasher(), _trustMtime,
+                                           current_time_ns()};
+    const FileTreeSnapshot *snapshot = _snapshot.get();
+    std::atomic< size_t > leasedBytes(0);
+    parallelFor(files.size(), _jobs,
+                [this, &files, &params, snapshot,
+                 &leasedBytes](size_t i, unsigned) {
+                    FileRecord &record = files[i]->record();
+                    const LazyUT::FileRecord *snapshotRecord =
+                        snapshot ? snapshot->find(record._path.joint())
+                                 : nullptr;
+                    if (snapshotRecord && _isChangesKnown &&
+                        !_changedFiles.count(record._path.jointUnix()) &&
+                        record.restoreHash(*snapshotRecord))
+                        return;
+                    record.calculateHash(_rootPath, params, snapshotRecord,
+                                         files[i]->isSourceFile());
+                    if (record.hasContent()) {
+                        // over the limit the parser reads the file again
+                        size_t size = record.content().size;
+                        if (leasedBytes.fetch_add(size) + size >
+                            contentLeaseLimit)
+                            record.takeContent();
+                    }
+                });
     _state = CachesCalculated;
 }
 
@@ -588,27 +744,311 @@ void FileTree::parseFiles()
     }
 }
 
-void FileTree::clearVisitedR()
+static void collectFiles(FileNode *node,
+                         FileNode::BoolProcedureCPtr checkSatisfy,
+                         std::vector< FileNode * > &files)
 {
-    for (FileNode *src : _vectorSourceFile)
-        src->clearVisited();
+    if ((node->*checkSatisfy)())
+        files.push_back(node);
+
+    for (auto child : node->childs())
+        collectFiles(child, checkSatisfy, files);
+}
+
+// Files reachable from the given ones by the explicit dependencies
+// (or dependent by), the given files included
+static std::vector< FileNode * >
+reachableFiles(const std::vector< FileNode * > &files,
+               FileNode::SetFileNode FileNode::*edges)
+{
+    FileNode::SetFileNode visited(files.begin(), files.end());
+    std::vector< FileNode * > queue(visited.begin(), visited.end());
+    for (size_t i = 0; i < queue.size(); ++i) {
+        for (FileNode *next : queue[i]->*edges) {
+            if (visited.insert(next).second)
+                queue.push_back(next);
+        }
+    }
+    return queue;
 }
 
 void FileTree::installAffectedFiles()
 {
-    assert(_affectedFiles.empty());
-    if (_rootDirectoryNode)
-        installAffectedFilesRecursive(_rootDirectoryNode);
+    if (!_rootDirectoryNode)
+        return;
+
+    std::vector< FileNode * > modifiedFiles;
+    collectFiles(_rootDirectoryNode, &FileNode::isModified, modifiedFiles);
+    installAffectedFiles(modifiedFiles);
 }
 
-void FileTree::parseModifiedFiles(const FileTree &restored_file_tree)
+void FileTree::installAffectedFiles(
+    const std::vector< FileNode * > &changedFiles)
+{
+    for (FileNode *file : _affectedFiles)
+        file->clearAffected();
+    _affectedFiles.clear();
+    if (!_rootDirectoryNode)
+        return;
+
+    std::vector< FileNode * > thisAffected(changedFiles);
+    collectFiles(_rootDirectoryNode, &FileNode::isManuallyLabeled,
+                 thisAffected);
+
+    std::vector< FileNode * > thisAffectedSources;
+    for (FileNode *file : thisAffected) {
+        if (file->isSourceFile())
+            thisAffectedSources.push_back(file);
+    }
+
+    auto install = [this](FileNode *file) {
+        if (file->isAffected())
+            return;
+        file->setAffected();
+        _affectedFiles.push_back(file);
+    };
+
+    // the dependency closure is kept by source files only, so:
+    // a source file is affected if it depends on an affected file
+    // (this uses affected)
+    for (FileNode *file : reachableFiles(
+             thisAffected, &FileNode::_setExplicitDependendentBy)) {
+        if (file->isSourceFile())
+            install(file);
+    }
+    // a file is affected if an affected source file depends on it
+    // (affected uses this)
+    for (FileNode *file : reachableFiles(thisAffectedSources,
+                                         &FileNode::_setExplicitDependencies))
+        install(file);
+}
+
+void FileTree::parseModifiedFiles()
 {
     assert(_state == CachesCalculated);
-    compareModifiedFilesRecursive(_rootDirectoryNode,
-                                  restored_file_tree._rootDirectoryNode);
+    compareModifiedFiles();
     parseModifiedSourceFiles();
 }
 
+// Explicit dependencies resolved in the previous run are restored for the
+// unchanged files, unless the change can resolve them differently
+struct FileTree::StoredDependencies
+{
+    // include directives are resolved the same way if include paths
+    // are the same and no file with the same name was added or removed
+    bool includes = false;
+    std::unordered_set< std::string > addedOrRemovedNames;
+    // implemented and base class files are the same
+    // if no declaration was added or removed
+    bool analysis = false;
+    // the declaration index of the dump is patched with the names of the
+    // parsed files, unless some name of the changed files is gone
+    bool declarations = false;
+};
+
+static std::string fileName(const std::string &path)
+{
+    return path.substr(path.find_last_of('/') + 1);
+}
+
+static bool includesAddedOrRemoved(
+    const LazyUT::FileRecord &record,
+    const std::unordered_set< std::string > &addedOrRemovedNames)
+{
+    if (addedOrRemovedNames.empty() || !record.includes())
+        return false;
+    for (const flatbuffers::String *include : *record.includes()) {
+        if (addedOrRemovedNames.count(fileName(include->str())))
+            return true;
+    }
+    return false;
+}
+
+// declared names with the scopes they are in
+static void addScopedNames(const std::unordered_set< ScopedName > &decls,
+                           std::unordered_set< std::string > &names)
+{
+    for (const ScopedName &decl : decls) {
+        std::string name;
+        for (const auto &part : decl.splitted()) {
+            if (!name.empty())
+                name += ScopedName::namespaceSep();
+            name += part.str();
+            names.insert(name);
+        }
+    }
+}
+
+// a name is gone if only the changed files declared it, names in its scope
+// can't be told from the dump then
+static bool lostDeclarations(
+    const DeclarationIndex::StoredDeclarations &stored,
+    const LazyUT::ListSplitted *changedNames,
+    const std::unordered_set< std::string > &parsedNames,
+    const FileTree::FileIdMap &files)
+{
+    if (!changedNames || !changedNames->splitted_paths())
+        return false;
+    for (const flatbuffers::String *name : *changedNames->splitted_paths()) {
+        if (parsedNames.count(name->str()))
+            continue;
+        const LazyUT::Declaration *decl = stored.LookupByKey(name->c_str());
+        if (!decl || !decl->files())
+            return true;
+        bool kept = false;
+        for (uint32_t id : *decl->files()) {
+            auto it = files.find(id);
+            if (it != files.end() && it->second->record().isUnchanged()) {
+                kept = true;
+                break;
+            }
+        }
+        if (!kept)
+            return true;
+    }
+    return false;
+}
+
+void FileTree::checkStoredDependencies(const std::vector< FileNode * > &files,
+                                       StoredDependencies &stored)
+{
+    std::vector< std::string > includePaths;
+    for (const FileNode *includePath : _includePaths)
+        includePaths.push_back(includePath->name());
+
+    stored.includes = _snapshot->includePaths() == includePaths;
+    stored.analysis = true;
+
+    // records of the modified and removed files
+    std::vector< const LazyUT::FileRecord * > changedRecords;
+    std::vector< const FileRecord * > parsedRecords;
+
+    for (FileNode *file : files) {
+        const FileRecord &record = file->record();
+        if (record.isUnchanged()) {
+            _snapshotFiles.insert(std::make_pair(record._id, file));
+            continue;
+        }
+        parsedRecords.push_back(&record);
+        if (record._id == FileRecord::noId) {
+            // added
+            stored.addedOrRemovedNames.insert(file->fname().str());
+            if (!record._setClassDecl.empty() || !record._setFuncDecl.empty())
+                stored.analysis = false;
+            continue;
+        }
+        _snapshotFiles.insert(std::make_pair(record._id, file));
+        const LazyUT::FileRecord *snapshotRecord =
+            _snapshot->find(file->path().joint());
+        if (snapshotRecord)
+            changedRecords.push_back(snapshotRecord);
+        if (!snapshotRecord ||
+            !FileTreeSnapshot::sameDeclarations(*snapshotRecord, record))
+            stored.analysis = false;
+    }
+
+    if (_snapshotFiles.size() < _snapshot->records().size()) {
+        for (const LazyUT::FileRecord *snapshotRecord : _snapshot->records()) {
+            if (_snapshotFiles.count(snapshotRecord->id()))
+                continue;
+            // removed
+            stored.addedOrRemovedNames.insert(
+                fileName(snapshotRecord->path()->str()));
+            changedRecords.push_back(snapshotRecord);
+            if (FileTreeSnapshot::hasDeclarations(*snapshotRecord))
+                stored.analysis = false;
+        }
+    }
+
+    const DeclarationIndex::StoredDeclarations *classDecls =
+        _snapshot->classDeclarations();
+    const DeclarationIndex::StoredDeclarations *funcDecls =
+        _snapshot->functionDeclarations();
+    stored.declarations = classDecls && funcDecls;
+    if (!stored.declarations || stored.analysis)
+        return; // the same names are declared
+
+    std::unordered_set< std::string > parsedClasses;
+    std::unordered_set< std::string > parsedFunctions;
+    for (const FileRecord *record : parsedRecords) {
+        addScopedNames(record->_setClassDecl, parsedClasses);
+        addScopedNames(record->_setFuncDecl, parsedFunctions);
+    }
+    for (const LazyUT::FileRecord *record : changedRecords) {
+        if (lostDeclarations(*classDecls, record->class_decls(), parsedClasses,
+                             _snapshotFiles) ||
+            lostDeclarations(*funcDecls, record->function_decls(),
+                             parsedFunctions, _snapshotFiles)) {
+            stored.declarations = false;
+            return;
+        }
+    }
+}
+
+void FileTree::assignFileIds(const std::vector< FileNode * > &files)
+{
+    for (FileNode *file : files) {
+        if (file->record()._id == FileRecord::noId)
+            file->record()._id = _nextFileId++;
+    }
+}
+
+void FileTree::resetDeclarations()
+{
+    _classDecls.reset(new DeclarationIndex("CLASSES"));
+    _funcDecls.reset(new DeclarationIndex("GLOBAL FUNCTIONS"));
+}
+
+void FileTree::restoreUnchangedFiles()
+{
+    const std::vector< FileNode * > files = _rootDirectoryNode->getFiles();
+    std::vector< FileNode * > unchangedFiles;
+    for (FileNode *file : files) {
+        if (file->record().isUnchanged())
+            unchangedFiles.push_back(file);
+    }
+
+    StoredDependencies stored;
+    _snapshotFiles.clear();
+    if (_snapshot) {
+        _nextFileId = std::max(_nextFileId, _snapshot->nextFileId());
+        checkStoredDependencies(files, stored);
+    }
+    assignFileIds(files);
+
+    resetDeclarations();
+    if (stored.declarations) {
+        _classDecls->restore(*_snapshot->classDeclarations(), _snapshotFiles);
+        _funcDecls->restore(*_snapshot->functionDeclarations(),
+                            _snapshotFiles);
+    }
+
+    const FileIdMap &snapshotFiles = _snapshotFiles;
+    parallelFor(unchangedFiles.size(), _jobs,
+                [&unchangedFiles, &stored, &snapshotFiles](size_t i,
+                                                           unsigned) {
+                    FileNode *file = unchangedFiles[i];
+                    FileRecord &record = file->record();
+                    const LazyUT::FileRecord &snapshotRecord =
+                        *record.unchangedSnapshot();
+
+                    if (stored.includes &&
+                        !includesAddedOrRemoved(snapshotRecord,
+                                                stored.addedOrRemovedNames) &&
+                        FileTreeSnapshot::restoreIncludedFiles(
+                            snapshotRecord, snapshotFiles,
+                            file->_includedFiles))
+                        file->setResolvedIncludes();
+                    if (stored.analysis &&
+                        FileTreeSnapshot::restoreAnalyzedData(
+                            snapshotRecord, snapshotFiles, record))
+                        file->setStoredAnalysis();
+
+                    record.restoreParsedData();
+                });
+    // the declaration index refers to the dump until it is written
+}
+
 void FileTree::print() const
 {
     if (!_rootDirectoryNode) {
@@ -671,6 +1111,31 @@ FileTree::State FileTree::state() const { return _state; }
 
 void FileTree::setState(const State &state) { _state = state; }
 
+const ContentHasher &FileTree::hasher() const
+{
+    const ContentHasher *result = ContentHasher::get(_hashAlgorithm);
+    assert(result);
+    return *result;
+}
+
+void FileTree::setJobs(unsigned jobs) { _jobs = (jobs > 0 ? jobs : 1); }
+
+void FileTree::setFastIncludes(
+    bool fast, const std::vector< std::string > &fullParseExtensions)
+{
+    _fastIncludes = fast;
+    _isFullParseLimited = !fullParseExtensions.empty();
+    _fullParseExtensions = ExtensionMatcher(fullParseExtensions);
+}
+
+void FileTree::setChangedFiles(const std::vector< SplittedPath > &paths)
+{
+    _isChangesKnown = true;
+    _changedFiles.clear();
+    for (const SplittedPath &path : paths)
+        _changedFiles.insert(path.jointUnix());
+}
+
 void FileTree::readFiles(const CommandLineArgs &clargs)
 {
     readSources(clargs.srcDirectories(), clargs.ignoredSubstrings());
@@ -678,15 +1143,27 @@ void FileTree::readFiles(const CommandLineArgs &clargs)
     _state = Filled;
 
     removeEmptyDirectories();
-    calculateFileHashes();
 }
 
-void FileTree::parsePhase(const SplittedPath &spFtreeDump)
+void FileTree::restoreSnapshot(const SplittedPath &spFtreeDump)
+{
+    restoreSnapshot(readBinaryFile(spFtreeDump.jointOs().c_str()));
+}
+
+void FileTree::restoreSnapshot(const FileData &ftreeDump)
+{
+    _snapshot.reset(new FileTreeSnapshot);
+    // hashes of another algorithm can't be compared,
+    // then every file is considered modified
+    if (!_snapshot->load(ftreeDump) ||
+        _snapshot->hashAlgorithm() != _hashAlgorithm)
+        _snapshot.reset();
+}
+
+void FileTree::parsePhase()
 {
-    FileTree restoredTree;
-    FileTreeFunc::deserialize(restoredTree, spFtreeDump);
-    if (restoredTree.state() == FileTree::Restored) {
-        parseModifiedFiles(restoredTree);
+    if (_snapshot) {
+        parseModifiedFiles();
     }
     else {
         // if deserialization failed just parse all
@@ -700,7 +1177,18 @@ void FileTree::writeAffectedFiles(const CommandLineArgs &clargs)
     create_directories(clargs.outDir());
 
     installAffectedFiles();
+    writeAffected(clargs);
+}
+void FileTree::writeAffectedFiles(const CommandLineArgs &clargs,
+                                  const std::vector< FileNode * > &changedFiles)
+{
+    create_directories(clargs.outDir());
 
+    installAffectedFiles(changedFiles);
+    writeAffected(clargs);
+}
+void FileTree::writeAffected(const CommandLineArgs &clargs) const
+{
     writeFiles(clargs.srcsAffected(), &FileNode::isAffectedSource);
     writeFiles(clargs.testsAffected(), &FileNode::isAffectedTest);
     writeFiles(clargs.testFilesPath(), &FileNode::isTestFile);
@@ -745,6 +1233,10 @@ static std::vector< FileNode * > searchTestMain(FileTree &testTree)
 
 void FileTree::labelTestMain()
 {
+    // labeled again after update()
+    for (FileNode *file : _rootDirectoryNode->getFiles())
+        file->clearLabeled();
+
     auto filesWithMain = searchTestMain(*this);
     for (FileNode *fileWithMain : filesWithMain)
         fileWithMain->setLabeled();
@@ -754,7 +1246,8 @@ void FileTree::readSources(const std::vector< SplittedPath > &relPaths,
                            const std::vector< std::string > &ignoredSubstrings)
 {
     DirectoryReader dr;
-    dr._ignore_substrings = ignoredSubstrings;
+    dr.setIgnoredSubstrings(ignoredSubstrings);
+    dr.setJobs(_jobs);
 
     for (const SplittedPath &relPath : relPaths)
         dr.readSources(relPath, *this);
@@ -788,8 +1281,8 @@ void FileTree::labelTest(const SplittedPath &relPath,
 
 void FileTree::analyzePhase()
 {
+    restoreUnchangedFiles();
     analyzeNodes();
-    propagateDeps();
 }
 
 void FileTree::printPaths(std::ostream &os,
@@ -802,11 +1295,17 @@ void FileTree::printPaths(std::ostream &os,
 void FileTree::writePaths(const SplittedPath &path,
                           const std::vector< SplittedPath > &paths) const
 {
-    /* open the file for writing*/
+    // readers (a build, --watch clients) never see a partly written list
+    const std::string fname = path.jointOs();
+    const std::string tmpName = fname + ".tmp";
     std::ofstream ofs;
-    ofs.open(path.jointOs(), std::ios_base::out);
-    if (ofs.is_open())
-        printPaths(ofs, paths);
+    ofs.open(tmpName, std::ios_base::out);
+    if (!ofs.is_open())
+        return;
+    printPaths(ofs, paths);
+    ofs.close();
+    if (ofs)
+        rename_file(tmpName.c_str(), fname.c_str());
 }
 
 static void pushFiles(const FileNode *file,
@@ -855,6 +1354,12 @@ void FileTree::installExtraDependencies(const SplittedPath &pathToExtraDeps)
     reader.set_extra_dependencies(pathToExtraDeps, *this);
 }
 
+void FileTree::addExtraDependency(FileNode *file, FileNode *dependency)
+{
+    file->addExplicitDep(dependency);
+    _extraDependencies.emplace_back(file, dependency);
+}
+
 void FileTree::addIncludePaths(const std::vector< SplittedPath > &paths)
 {
     for (const SplittedPath &path : paths)
@@ -887,39 +1392,43 @@ FileTree::affectedFiles(const SplittedPath &spBase,
 
 void FileTree::parseModifiedSourceFiles()
 {
+    std::vector< FileNode * > modifiedFiles;
     for (FileNode *src : _vectorSourceFile) {
         if (src->isModified())
-            _srcParser.parseFile(src);
+            modifiedFiles.push_back(src);
     }
+    parseSourceFiles(modifiedFiles);
 }
 
-void FileTree::compareModifiedFilesRecursive(FileNode *node,
-                                             FileNode *restored_node)
+void FileTree::parseSourceFiles(const std::vector< FileNode * > &files)
 {
-    auto thisChilds = node->childs();
-    if (node->isRegularFile()) {
-        if (restored_node->isRegularFile() &&
-            compareHashArrays(node->record()._hashArray,
-                              restored_node->record()._hashArray)) {
-            // md5 hash sums match
-            node->swapParsedData(restored_node);
-        }
-        else {
-            // md5 hash sums don't match
-            node->setModified();
-        }
-    }
-    for (auto child : thisChilds) {
-        if (FileNode *restored_child =
-                restored_node->findChild(child->fname())) {
-            compareModifiedFilesRecursive(child, restored_child);
-        }
-        else {
-            if (clargs.verbal()) {
-                std::cout << "this " << node->name() << " child "
-                          << child->fname() << " not found" << std::endl;
-            }
-            installModifiedFiles(child);
+    if (files.empty())
+        return;
+
+    // include directives are resolved while parsing, so fill the lazy path
+    // caches first: concurrent searches in the tree then only read it
+    recursiveCall(*_rootDirectoryNode, &FileNode::cachePath);
+
+    // the parser keeps per-file state, so each worker gets its own one;
+    // parse results are written to the parsed file's record only
+    std::vector< SourceParser > parsers(_jobs, SourceParser(*this));
+    parallelFor(files.size(), _jobs,
+                [&parsers, &files](size_t i, unsigned worker) {
+                    parsers[worker].parseFile(files[i]);
+                });
+}
+
+void FileTree::compareModifiedFiles()
+{
+    for (FileNode *file : _rootDirectoryNode->getFiles()) {
+        if (file->record().isUnchanged())
+            continue; // hash sums match
+
+        // hash sums don't match
+        file->setModified();
+        if (clargs.verbal() && !_snapshot->find(file->path().joint())) {
+            std::cout << "this " << file->parent()->name() << " child "
+                      << file->fname() << " not found" << std::endl;
         }
     }
 }
@@ -935,28 +1444,284 @@ void FileTree::installModifiedFiles(FileNode *node)
         installModifiedFiles(child);
 }
 
-void FileTree::installAffectedFilesRecursive(FileNode *node)
-{
-    if (node->isAffected())
-        _affectedFiles.push_back(node);
-
-    for (auto child : node->childs())
-        installAffectedFilesRecursive(child);
-}
-
 void FileTree::analyzeNodes()
 {
-    DependencyAnalyzer dep;
+    _dependencyClosure.reset();
+
+    if (!_classDecls)
+        resetDeclarations();
+    DependencyAnalyzer dep(*_classDecls, *_funcDecls);
     dep.analyze(_rootDirectoryNode);
 
     for (FileNode *src : _vectorSourceFile)
         src->initExplicitDeps();
 }
 
-void FileTree::propagateDeps()
+bool FileTree::isReadable(const SplittedPath &relPath,
+                          const CommandLineArgs &clargs) const
+{
+    // as DirectoryReader would read it
+    if (SubstringMatcher(clargs.ignoredSubstrings())
+            .matches((_rootPath + relPath).jointUnix()))
+        return false;
+    std::vector< SplittedPath > dirs = clargs.srcDirectories();
+    const std::vector< SplittedPath > testDirs = clargs.testDirectories();
+    dirs.insert(dirs.end(), testDirs.begin(), testDirs.end());
+    for (const SplittedPath &dir : dirs) {
+        bool error = false;
+        relative_path(relPath, dir, &error);
+        if (!error)
+            return true;
+    }
+    return false;
+}
+
+void FileTree::removeFile(FileNode *file)
 {
-    for (FileNode *src : _vectorSourceFile)
-        src->installDependencies();
+    for (FileNode *dependency : file->_setExplicitDependencies)
+        dependency->_setExplicitDependendentBy.erase(file);
+    for (FileNode *dependent : file->_setExplicitDependendentBy) {
+        dependent->_setExplicitDependencies.erase(file);
+        // resolved again, the files including it have a changed name
+        remove_one(dependent->_includedFiles, file);
+    }
+    _extraDependencies.erase(
+        std::remove_if(_extraDependencies.begin(), _extraDependencies.end(),
+                       [file](const std::pair< FileNode *, FileNode * > &dep) {
+                           return dep.first == file || dep.second == file;
+                       }),
+        _extraDependencies.end());
+    // a file may take the place of an emptied directory
+    FileNode *parent = file->parent();
+    file->destroy();
+    while (parent != _rootDirectoryNode && parent->childs().empty() &&
+           std::find(_includePaths.begin(), _includePaths.end(), parent) ==
+               _includePaths.end()) {
+        FileNode *directory = parent;
+        parent = parent->parent();
+        directory->destroy();
+    }
+}
+
+// analyzes the file again; if its implemented or base class files change,
+// the explicit dependencies of the previous ones are removed
+static bool reanalyzeFile(FileNode *file, DependencyAnalyzer &analyzer,
+                          FileNode::SetFileNode &ends)
+{
+    FileRecord &record = file->record();
+    std::unordered_set< ScopedName > implementFiles;
+    std::unordered_set< ScopedName > baseClassFiles;
+    implementFiles.swap(record._setImplementFiles);
+    baseClassFiles.swap(record._setBaseClassFiles);
+    record.clearAnalyzedData();
+    analyzer.analyzeFile(file);
+    if (implementFiles == record._setImplementFiles &&
+        baseClassFiles == record._setBaseClassFiles)
+        return false;
+
+    implementFiles.swap(record._setImplementFiles);
+    baseClassFiles.swap(record._setBaseClassFiles);
+    file->removeExplicitDeps(ends);
+    implementFiles.swap(record._setImplementFiles);
+    baseClassFiles.swap(record._setBaseClassFiles);
+    return true;
+}
+
+// the file names the include directives of the record refer to
+static bool includesAnyOf(const FileRecord &record,
+                          const std::unordered_set< std::string > &names)
+{
+    for (const IncludeDirective &include : record._listIncludes) {
+        if (names.count(fileName(include.filename)))
+            return true;
+    }
+    return false;
+}
+
+void FileTree::update(const std::vector< SplittedPath > &paths,
+                      const CommandLineArgs &clargs)
+{
+    _dependencyClosure.reset();
+
+    std::vector< FileNode * > removedFiles;
+    std::vector< FileNode * > touchedFiles;
+    std::unordered_set< FileNode * > known;
+    for (const SplittedPath &path : paths) {
+        FileNode *node = searchInRoot(path);
+        if (!node || node == _rootDirectoryNode)
+            continue; // added, once the removed files make room for it
+        const SplittedPath fullPath = _rootPath + path;
+        const bool isRemoved = node->isDirectory() ? !is_directory(fullPath)
+                                                   : !is_file(fullPath);
+        if (node->isDirectory() && !isRemoved)
+            continue; // its new files are listed
+        for (FileNode *file : node->getFiles()) {
+            if (known.insert(file).second)
+                (isRemoved ? removedFiles : touchedFiles).push_back(file);
+        }
+    }
+
+    // include directives naming these may resolve differently
+    std::unordered_set< std::string > changedNames;
+    bool isDeclarationChanged = false;
+    bool isTestChanged = false;
+
+    for (FileNode *file : removedFiles) {
+        changedNames.insert(file->fname().str());
+        const FileRecord &record = file->record();
+        if (!record._setClassDecl.empty() || !record._setFuncDecl.empty())
+            isDeclarationChanged = true;
+        isTestChanged = isTestChanged || file->isTestFile();
+    }
+    if (!removedFiles.empty()) {
+        const std::unordered_set< FileNode * > removed(removedFiles.begin(),
+                                                       removedFiles.end());
+        auto isRemoved = [&removed](FileNode *file) {
+            return removed.count(file) != 0;
+        };
+        _vectorSourceFile.erase(std::remove_if(_vectorSourceFile.begin(),
+                                               _vectorSourceFile.end(),
+                                               isRemoved),
+                                _vectorSourceFile.end());
+        _affectedFiles.erase(std::remove_if(_affectedFiles.begin(),
+                                            _affectedFiles.end(), isRemoved),
+                             _affectedFiles.end());
+        for (FileNode *file : removedFiles)
+            removeFile(file);
+    }
+
+    const size_t addedBegin = touchedFiles.size();
+    const ExtensionMatcher sourceExtensions(
+        DirectoryReader::_sourceFileExtensions);
+    for (const SplittedPath &path : paths) {
+        if (searchInRoot(path) || !is_file(_rootPath + path) ||
+            !isReadable(path, clargs))
+            continue;
+        FileNode *file = addFile(path);
+        file->record()._id = _nextFileId++;
+        if (sourceExtensions.matches(file->fname().str()))
+            file->setSourceFile();
+        for (const SplittedPath &dir : clargs.testDirectories()) {
+            bool error = false;
+            relative_path(path, dir, &error);
+            if (!error) {
+                file->setTestIfMatchPatterns(clargs.testPatterns());
+                break;
+            }
+        }
+        changedNames.insert(file->fname().str());
+        touchedFiles.push_back(file);
+    }
+
+    // the files with new contents, their explicit dependencies
+    // are removed and installed again
+    std::vector< FileNode * > parsedFiles;
+    FileNode::SetFileNode ends;
+    std::vector< std::unordered_set< ScopedName > > declarations;
+    const FileRecord::HashParams params = {&hasher(), false,
+                                           current_time_ns()};
+    size_t leasedBytes = 0;
+    for (size_t i = 0; i < touchedFiles.size(); ++i) {
+        FileNode *file = touchedFiles[i];
+        FileRecord &record = file->record();
+        const bool isAdded = i >= addedBegin;
+        ContentHasher::HashArray hash;
+        copyHashArray(hash, record._hashArray);
+        const bool wasHashValid = record._isHashValid;
+
+        record.calculateHash(_rootPath, params, nullptr,
+                             file->isSourceFile());
+        if (!isAdded && wasHashValid && record._isHashValid &&
+            memcmp(hash, record._hashArray, ContentHasher::hashSize) == 0) {
+            record.takeContent();
+            continue;
+        }
+        if (!record._isHashValid)
+            continue; // removed before it was read, it is listed again
+        if (!file->isSourceFile())
+            continue; // never parsed
+        leasedBytes += record.content().size;
+        if (leasedBytes > contentLeaseLimit)
+            record.takeContent();
+
+        isTestChanged = isTestChanged || file->isTestFile();
+        file->removeExplicitDeps(ends);
+        file->resetIncludes();
+        declarations.push_back(record._setClassDecl);
+        declarations.push_back(record._setFuncDecl);
+        record.clearParsedData();
+        record.clearAnalyzedData();
+        parsedFiles.push_back(file);
+    }
+    parseSourceFiles(parsedFiles);
+    for (size_t i = 0; i < parsedFiles.size(); ++i) {
+        const FileRecord &record = parsedFiles[i]->record();
+        if (declarations[2 * i] != record._setClassDecl ||
+            declarations[2 * i + 1] != record._setFuncDecl)
+            isDeclarationChanged = true;
+    }
+
+    std::unordered_set< FileNode * > changedFiles(parsedFiles.begin(),
+                                                  parsedFiles.end());
+    if (!changedNames.empty()) {
+        for (FileNode *src : _vectorSourceFile) {
+            if (changedFiles.count(src) ||
+                !includesAnyOf(src->record(), changedNames))
+                continue;
+            src->removeExplicitDeps(ends);
+            src->resetIncludes();
+            changedFiles.insert(src);
+        }
+    }
+
+    // the trie of the names can't drop a file, nor refer to the snapshot
+    // once it is gone
+    if (isDeclarationChanged || _snapshot) {
+        _snapshot.reset();
+        _snapshotFiles.clear();
+        resetDeclarations();
+        DependencyAnalyzer(*_classDecls, *_funcDecls)
+            .readDecls(_rootDirectoryNode);
+    }
+    DependencyAnalyzer analyzer(*_classDecls, *_funcDecls);
+    if (isDeclarationChanged) {
+        // any file may implement or inherit the names
+        const std::unordered_set< FileNode * > parsed(parsedFiles.begin(),
+                                                      parsedFiles.end());
+        for (FileNode *file : _rootDirectoryNode->getFiles()) {
+            if (parsed.count(file))
+                analyzer.analyzeFile(file);
+            else if (reanalyzeFile(file, analyzer, ends))
+                changedFiles.insert(file);
+        }
+    }
+    else {
+        for (FileNode *file : parsedFiles)
+            analyzer.analyzeFile(file);
+    }
+
+    // edges removed with the changed files may be installed by the files
+    // at the other ends, or be extra dependencies
+    for (FileNode *file : ends) {
+        if (file->isSourceFile())
+            changedFiles.insert(file);
+    }
+    for (FileNode *file : changedFiles) {
+        if (file->isSourceFile())
+            file->initExplicitDeps();
+    }
+    for (const auto &dep : _extraDependencies)
+        dep.first->addExplicitDep(dep.second);
+
+    if (isTestChanged && !clargs.isNoMain())
+        labelTestMain();
+}
+
+const DependencyClosure &FileTree::dependencyClosure() const
+{
+    if (!_dependencyClosure)
+        _dependencyClosure.reset(new DependencyClosure(_vectorSourceFile));
+    return *_dependencyClosure;
 }
 
 FileNode *FileTree::searchIncludedFile(const IncludeDirective &id,
@@ -1,16 +1,23 @@
 #ifndef FILE_TREE_HPP
 #define FILE_TREE_HPP
 
-#include "extensions/md5.hpp"
+#include "extensions/content_hasher.hpp"
+#include "extensions/string_matchers.hpp"
 #include "types/splitted_string.hpp"
 #include "parsers/sourceparser.hpp"
 
 #include <string>
 #include <list>
+#include <memory>
 #include <set>
+#include <unordered_map>
 
 using std::string;
 
+namespace LazyUT {
+struct FileRecord;
+} // namespace LazyUT
+
 struct IncludeDirective
 {
     enum SeqCharType { Quotes, Brackets };
@@ -36,7 +43,30 @@ public:
     FileRecord(const SplittedPath &path, Type type);
 
 public:
-    void calculateHash(const SplittedPath &dir_base);
+    // the same for every record hashed in a run
+    struct HashParams
+    {
+        const ContentHasher *hasher;
+        // reuse the hash of the snapshot record if stat() matches
+        bool trustStat;
+        // stat of files modified after racyTimeNs - racyWindow isn't stored
+        uint64_t racyTimeNs;
+    };
+
+    // snapshot is the record of the file in the previous run's dump.
+    // keepContent leaves the read contents in the record for the parser,
+    // unless the hash matches the snapshot one
+    void calculateHash(const SplittedPath &dir_base, const HashParams &params,
+                       const LazyUT::FileRecord *snapshot = nullptr,
+                       bool keepContent = false);
+
+    // the file is known to have the snapshot contents, it isn't read;
+    // false if the snapshot has no valid hash
+    bool restoreHash(const LazyUT::FileRecord &snapshot);
+
+    bool hasContent() const { return _content.data != nullptr; }
+    const FileData &content() const { return _content; }
+    FileData takeContent();
 
     bool isRegularFile() const { return _type == RegularFile; }
     bool isDirectory() const { return _type == Directory; }
@@ -48,7 +78,17 @@ public:
     SplittedPath _path;
     Type _type;
 
-    void swapParsedData(FileRecord &record);
+    // the snapshot record has the same contents, parsed data
+    // is restored from it instead of parsing the file
+    bool isUnchanged() const { return _unchangedSnapshot != nullptr; }
+    const LazyUT::FileRecord *unchangedSnapshot() const
+    {
+        return _unchangedSnapshot;
+    }
+    void restoreParsedData();
+    // before the file is parsed or analyzed again
+    void clearParsedData();
+    void clearAnalyzedData();
 
     // Parse stage
     std::vector< IncludeDirective > _listIncludes;
@@ -65,8 +105,22 @@ public:
     std::unordered_set< ScopedName > _setImplementFiles;
 
 public:
-    MD5::HashArray _hashArray;
+    ContentHasher::HashArray _hashArray;
     bool _isHashValid;
+
+    // stat() of the file when it was hashed, unknown for racily clean files
+    FileStat _stat;
+
+    // stable between runs, the snapshot refers to files by ids;
+    // noId for files which aren't in the snapshot until FileTree assigns one
+    static const uint32_t noId = 0;
+    uint32_t _id;
+
+private:
+    // contents read while hashing, leased to the parser
+    FileData _content;
+    // snapshot record with the same hash, until parsed data is restored
+    const LazyUT::FileRecord *_unchangedSnapshot;
 };
 
 class FileTree;
@@ -78,7 +132,13 @@ public:
         Modified = 0x1,
         Labeled = 0x2,
         SourceFile = 0x4,
-        TestFile = 0x8
+        TestFile = 0x8,
+        Affected = 0x10,
+        // include directives resolved into _includedFiles,
+        // restored from the snapshot or not
+        ResolvedIncludes = 0x20,
+        // explicit dependencies restored from the snapshot
+        StoredAnalysis = 0x40
     };
     using FlagsType = uint8_t;
 
@@ -100,6 +160,8 @@ public:
     void addChild(FileNode *child);
     FileNode *findOrNewChild(const HashedFileName &hfname,
                              FileRecord::Type type);
+    // the caller knows there is no child with the name
+    FileNode *newChild(const HashedFileName &hfname, FileRecord::Type type);
     void removeChild(FileNode *child);
 
     const FileRecord &record() const { return _record; }
@@ -116,6 +178,7 @@ public:
 
     const std::string &name() const { return path().joint(); }
     SplittedPath fullPath() const;
+    void cachePath() const;
 
     std::string relativeName(const SplittedPath &base) const;
 
@@ -125,28 +188,26 @@ public:
 
     void destroy();
 
-    void installDependencies();
-    void installDependentBy();
-    void clearVisited();
-
     void initExplicitDeps();
+    // removes the explicit dependencies initExplicitDeps() added,
+    // the files at the other ends are inserted into ends
+    void removeExplicitDeps(SetFileNode &ends);
 
     FileNode *search(const SplittedPath &path);
 
-    void addDependency(FileNode *node);
-    void addDependencies(const SetFileNode &nodes);
-
-    void addDependentBy(FileNode *node);
+    // transitive closures of the explicit dependencies,
+    // see DependencyClosure
+    ListFileNode dependencies() const;
+    ListFileNode dependentBy() const;
 
     void addExplicitDep(FileNode *includedNode);
     void addExplicitDepBy(FileNode *implementedNode);
 
-    void swapParsedData(FileNode *file);
-
     void setModified() { _flags |= Flags::Modified; }
     bool isModified() const { return _flags & Flags::Modified; }
 
     void setLabeled() { _flags |= Flags::Labeled; }
+    void clearLabeled() { _flags &= ~Flags::Labeled; }
     bool isManuallyLabeled() const { return _flags & Flags::Labeled; }
 
     void setSourceFile();
@@ -156,7 +217,22 @@ public:
     bool isTestFile() const { return _flags & Flags::TestFile; }
 
     bool isThisAffected() const { return isModified() || isManuallyLabeled(); }
-    bool isAffected() const;
+
+    // set by FileTree::installAffectedFiles()
+    void setAffected() { _flags |= Flags::Affected; }
+    void clearAffected() { _flags &= ~Flags::Affected; }
+    bool isAffected() const { return _flags & Flags::Affected; }
+
+    void setResolvedIncludes() { _flags |= Flags::ResolvedIncludes; }
+    bool hasResolvedIncludes() const
+    {
+        return _flags & Flags::ResolvedIncludes;
+    }
+    // the include directives are resolved again by initExplicitDeps()
+    void resetIncludes();
+
+    void setStoredAnalysis() { _flags |= Flags::StoredAnalysis; }
+    bool hasStoredAnalysis() const { return _flags & Flags::StoredAnalysis; }
 
     FlagsType flags() const { return _flags; }
     bool checkFlags(FlagsType fls) const { return _flags & fls; }
@@ -186,26 +262,27 @@ public:
     ///
 private:
     void installIncludes();
+    void resolveIncludes();
     void installInheritances();
     void installImplements();
 
-    void installDependenciesR(FileNode *node);
-
     FileNode *_parent;
     ListFileNode _childs;
+    // child by name, built once a directory has many children
+    std::unique_ptr< std::unordered_map< SymbolTable::Id, FileNode * > >
+        _childIndex;
     FileRecord _record;
 
 public:
     SetFileNode _setExplicitDependencies;
     SetFileNode _setExplicitDependendentBy;
 
-    SetFileNode _setDependencies;
-    SetFileNode _setDependentBy;
+    // resolved include directives of the record
+    ListFileNode _includedFiles;
 
     FileTree &_fileTree;
 
 private:
-    bool _visited;
     FlagsType _flags;
 };
 
@@ -220,6 +297,9 @@ inline void setLabeled(FileNode *f)
 } // namespace FileNodeFunc
 
 class CommandLineArgs;
+class DependencyClosure;
+class DeclarationIndex;
+class FileTreeSnapshot;
 class FileTree
 {
 public:
@@ -233,18 +313,22 @@ public:
         Error
     };
 
+    using FileIdMap = std::unordered_map< uint32_t, FileNode * >;
+
     FileTree();
+    ~FileTree();
 
     void clean();
     void removeEmptyDirectories();
     void calculateFileHashes();
     void parseFiles();
 
-    void clearVisitedR();
-
     void installAffectedFiles();
+    // affected by the given files instead of the modified ones
+    void installAffectedFiles(const std::vector< FileNode * > &changedFiles);
 
-    void parseModifiedFiles(const FileTree &restored_file_tree);
+    void parseModifiedFiles();
+    void restoreUnchangedFiles();
 
     ///---Debug
     void print() const;
@@ -265,9 +349,43 @@ public:
     State state() const;
     void setState(const State &state);
 
+    unsigned jobs() const { return _jobs; }
+    void setJobs(unsigned jobs);
+
+    bool isTrustMtime() const { return _trustMtime; }
+    void setTrustMtime(bool trust) { _trustMtime = trust; }
+
+    // only the include directives are read of the files which can't
+    // declare anything, and of those not of the full parse extensions,
+    // if any (--fast-includes)
+    bool isFastIncludes() const { return _fastIncludes; }
+    void setFastIncludes(bool fast,
+                         const std::vector< std::string > &fullParseExtensions);
+    bool mayDeclare(const std::string &fileName) const
+    {
+        return !_isFullParseLimited || _fullParseExtensions.matches(fileName);
+    }
+
+    // only these files may differ from the snapshot (--changed-from),
+    // the other files of the snapshot aren't read
+    void setChangedFiles(const std::vector< SplittedPath > &paths);
+
+    ContentHasher::Algorithm hashAlgorithm() const { return _hashAlgorithm; }
+    void setHashAlgorithm(ContentHasher::Algorithm algorithm)
+    {
+        _hashAlgorithm = algorithm;
+    }
+    const ContentHasher &hasher() const;
+
+    uint32_t nextFileId() const { return _nextFileId; }
+
     void readFiles(const CommandLineArgs &clargs);
-    void parsePhase(const SplittedPath &spFtreeDump);
+    void restoreSnapshot(const SplittedPath &spFtreeDump);
+    void restoreSnapshot(const FileData &ftreeDump);
+    void parsePhase();
     void writeAffectedFiles(const CommandLineArgs &clargs);
+    void writeAffectedFiles(const CommandLineArgs &clargs,
+                            const std::vector< FileNode * > &changedFiles);
     void labelTestMain();
 
     void readSources(const std::vector< SplittedPath > &relPaths,
@@ -291,8 +409,20 @@ public:
                     FileNode::BoolProcedureCPtr checkSatisfy) const;
     int writeFiles(std::ostream &os,
                    FileNode::BoolProcedureCPtr checkSatisfy) const;
+    // the output files of the affected files installed already
+    void writeAffected(const CommandLineArgs &clargs) const;
 
     void installExtraDependencies(const SplittedPath &pathToExtraDeps);
+    void addExtraDependency(FileNode *file, FileNode *dependency);
+
+    // Applies the changes of the given files, relative to the root, to the
+    // analyzed tree in place: removed files (or directories) are dropped,
+    // added files are read, the others are hashed again, and only the
+    // files with new contents are parsed. The explicit dependencies are
+    // installed again around the files whose parsed or analyzed data
+    // changed. The tree doesn't refer to the snapshot afterwards.
+    void update(const std::vector< SplittedPath > &paths,
+                const CommandLineArgs &clargs);
 
 public:
     SplittedPath _projectDirectory;
@@ -310,14 +440,25 @@ public:
                                               FileNode::FlagsType flags) const;
 
 public:
-    void compareModifiedFilesRecursive(FileNode *node, FileNode *restored_node);
+    void compareModifiedFiles();
     void installModifiedFiles(FileNode *node);
     void parseModifiedSourceFiles();
 
-    void installAffectedFilesRecursive(FileNode *node);
-
     void analyzeNodes();
-    void propagateDeps();
+
+    // built on the first call after analyzeNodes(), the affected files
+    // don't need it
+    const DependencyClosure &dependencyClosure() const;
+
+    // names declared by the files, written to the dump
+    const DeclarationIndex *classDeclarations() const
+    {
+        return _classDecls.get();
+    }
+    const DeclarationIndex *functionDeclarations() const
+    {
+        return _funcDecls.get();
+    }
 
     template < typename TFunc, typename... TArgs >
     void recursiveCall(FileNode &node, TFunc f, TArgs... args)
@@ -336,9 +477,24 @@ public:
     FileNode *searchInRoot(const SplittedPath &path) const;
 
 private:
+    struct StoredDependencies;
+
     void updateRoot();
     int countTestFile() const;
 
+    void checkStoredDependencies(const std::vector< FileNode * > &files,
+                                 StoredDependencies &stored);
+    void assignFileIds(const std::vector< FileNode * > &files);
+    void resetDeclarations();
+    void parseSourceFiles(const std::vector< FileNode * > &files);
+
+    // update() steps
+    bool isReadable(const SplittedPath &relPath,
+                    const CommandLineArgs &clargs) const;
+    // detaches and destroys the file, the caller drops it from
+    // _vectorSourceFile and _affectedFiles
+    void removeFile(FileNode *file);
+
 private:
     FileNode *_rootDirectoryNode;
     std::vector< FileNode * > _includePaths;
@@ -346,9 +502,29 @@ private:
 
     SplittedPath _rootPath;
 
-    SourceParser _srcParser;
     SplittedPath _relativeBasePath;
     State _state;
+    unsigned _jobs;
+    bool _trustMtime;
+    bool _fastIncludes;
+    bool _isFullParseLimited;
+    ExtensionMatcher _fullParseExtensions;
+    bool _isChangesKnown;
+    std::unordered_set< std::string > _changedFiles;
+    ContentHasher::Algorithm _hashAlgorithm;
+    uint32_t _nextFileId;
+
+    // file tree dump of the previous run, if any
+    std::unique_ptr< FileTreeSnapshot > _snapshot;
+    // files of the dump which are still in the tree
+    FileIdMap _snapshotFiles;
+
+    mutable std::unique_ptr< DependencyClosure > _dependencyClosure;
+    std::unique_ptr< DeclarationIndex > _classDecls;
+    std::unique_ptr< DeclarationIndex > _funcDecls;
+
+    // installed by installExtraDependencies(), update() installs them again
+    std::vector< std::pair< FileNode *, FileNode * > > _extraDependencies;
 
 public:
     // optimization
@@ -0,0 +1,134 @@
+#include "types/name_trie.hpp"
+#include "types/file_tree.hpp"
+
+#include <iostream>
+
+namespace {
+
+const uint32_t noEntry = UINT32_MAX;
+const size_t initialSlots = 64;
+
+} // namespace
+
+NameTrie::NameTrie(const std::string &name)
+    : _name(name), _slots(initialSlots, Slot{noNode, 0, noNode})
+{
+    _nodes.push_back(NodeData{noNode, SymbolTable::emptyId, noEntry, noEntry});
+}
+
+void NameTrie::insert(const ScopedName &name, FileNode *file)
+{
+    Node node = root();
+    for (const auto &part : name.splitted())
+        node = findOrAdd(node, part);
+
+    const uint32_t entry = static_cast< uint32_t >(_files.size());
+    _files.push_back(FileEntry{file, noEntry});
+
+    NodeData &data = _nodes[node];
+    if (data.lastFile == noEntry)
+        data.firstFile = entry;
+    else
+        _files[data.lastFile].next = entry;
+    data.lastFile = entry;
+}
+
+NameTrie::Node NameTrie::find(Node parent, const HashedString &part) const
+{
+    return _slots[slotOf(parent, part.id())].child;
+}
+
+NameTrie::Node NameTrie::findSplitted(const ScopedName &name) const
+{
+    Node node = root();
+    for (const auto &part : name.splitted()) {
+        node = find(node, part);
+        if (node == noNode)
+            return noNode;
+    }
+    return node;
+}
+
+void NameTrie::appendFiles(Node node, Files &files) const
+{
+    for (uint32_t entry = _nodes[node].firstFile; entry != noEntry;
+         entry = _files[entry].next)
+        files.push_back(_files[entry].file);
+}
+
+void NameTrie::forEach(
+    const std::function< void(const std::string &, const Files &) > &f) const
+{
+    // parents go before their children
+    std::vector< std::string > names(_nodes.size());
+    Files files;
+    for (Node node = 1; node < _nodes.size(); ++node) {
+        const NodeData &data = _nodes[node];
+        if (data.parent != root())
+            names[node] = names[data.parent] + ScopedName::namespaceSep();
+        names[node] += SymbolTable::str(data.part);
+
+        if (data.firstFile == noEntry)
+            continue;
+        files.clear();
+        appendFiles(node, files);
+        f(names[node], files);
+    }
+}
+
+void NameTrie::print() const
+{
+    std::vector< int > depth(_nodes.size(), 0);
+    for (Node node = 0; node < _nodes.size(); ++node) {
+        const NodeData &data = _nodes[node];
+        if (node != root())
+            depth[node] = depth[data.parent] + 1;
+        std::string strIndents = makeIndents(depth[node], 0);
+
+        std::cout << strIndents
+                  << (node == root() ? _name : SymbolTable::str(data.part))
+                  << std::endl;
+        Files files;
+        appendFiles(node, files);
+        for (const FileNode *fn : files)
+            std::cout << strIndents << "-- " << fn->name() << std::endl;
+    }
+}
+
+NameTrie::Node NameTrie::findOrAdd(Node parent, const HashedString &part)
+{
+    size_t slot = slotOf(parent, part.id());
+    if (_slots[slot].child != noNode)
+        return _slots[slot].child;
+
+    const Node node = static_cast< Node >(_nodes.size());
+    _nodes.push_back(NodeData{parent, part.id(), noEntry, noEntry});
+    _slots[slot] = Slot{parent, part.id(), node};
+
+    if (2 * _nodes.size() > _slots.size())
+        grow();
+    return node;
+}
+
+size_t NameTrie::slotOf(Node parent, SymbolTable::Id part) const
+{
+    const uint64_t key = uint64_t(parent) << 32 | part;
+    const size_t mask = _slots.size() - 1;
+    size_t slot = static_cast< size_t >((key * 0x9E3779B97F4A7C15ull) >> 32) &
+                  mask;
+    // linear probing up to the slot of the key or an empty one
+    while (_slots[slot].child != noNode &&
+           (_slots[slot].parent != parent || _slots[slot].part != part))
+        slot = (slot + 1) & mask;
+    return slot;
+}
+
+void NameTrie::grow()
+{
+    std::vector< Slot > slots(_slots.size() * 2, Slot{noNode, 0, noNode});
+    slots.swap(_slots);
+    for (const Slot &slot : slots) {
+        if (slot.child != noNode)
+            _slots[slotOf(slot.parent, slot.part)] = slot;
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef NAME_TRIE_HPP
+#define NAME_TRIE_HPP
+
+#include "types/splitted_string.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+class FileNode;
+
+// Trie of scoped names with the files declaring them. Nodes live in one
+// array and are referred to by index; the children of all the nodes are
+// found through one open addressing table keyed by the parent and the
+// symbol id of the name part, so a lookup doesn't chase pointers.
+class NameTrie
+{
+public:
+    using Node = uint32_t;
+    using Files = std::vector< FileNode * >;
+
+    // not found
+    static const Node noNode = UINT32_MAX;
+
+    explicit NameTrie(const std::string &name);
+
+    Node root() const { return 0; }
+
+    void insert(const ScopedName &name, FileNode *file);
+
+    Node find(Node parent, const HashedString &part) const;
+    Node findSplitted(const ScopedName &name) const;
+
+    // in the order of insertion
+    void appendFiles(Node node, Files &files) const;
+
+    // declared names, joined with the namespace separator
+    void forEach(
+        const std::function< void(const std::string &, const Files &) > &f)
+        const;
+
+    /// DEBUG
+    void print() const;
+    ///
+private:
+    struct NodeData
+    {
+        Node parent;
+        SymbolTable::Id part;
+        uint32_t firstFile;
+        uint32_t lastFile;
+    };
+
+    struct FileEntry
+    {
+        FileNode *file;
+        uint32_t next;
+    };
+
+    struct Slot
+    {
+        Node parent;
+        SymbolTable::Id part;
+        Node child;
+    };
+
+    Node findOrAdd(Node parent, const HashedString &part);
+    size_t slotOf(Node parent, SymbolTable::Id part) const;
+    void grow();
+
+    std::string _name;
+    std::vector< NodeData > _nodes;
+    std::vector< FileEntry > _files;
+    // power of two sized, at most half full
+    std::vector< Slot > _slots;
+};
+
+#endif // NAME_TRIE_HPP
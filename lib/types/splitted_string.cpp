@@ -14,10 +14,10 @@
 #define STR_DOT (".")
 #define STR_DOT_DOT ("..")
 
-const MurmurHashType HashedFileName::_hashDot =
-    MurmurHash2(STR_DOT, strlen(STR_DOT));
-const MurmurHashType HashedFileName::_hashDotDot =
-    MurmurHash2(STR_DOT_DOT, strlen(STR_DOT_DOT));
+const SymbolTable::Id HashedFileName::_idDot =
+    SymbolTable::intern(STR_DOT, strlen(STR_DOT));
+const SymbolTable::Id HashedFileName::_idDotDot =
+    SymbolTable::intern(STR_DOT_DOT, strlen(STR_DOT_DOT));
 
 const char *get_home_dir()
 {
@@ -38,18 +38,6 @@ const char *get_home_dir()
     return homedir;
 }
 
-HashedString::HashedString(const std::string &str) : std::string(str), _hash(0)
-{
-}
-
-MurmurHashType HashedString::hash() const
-{
-    if (_hash == 0)
-        _hash = MurmurHash2(c_str(), length());
-
-    return _hash;
-}
-
 HashedFileName::HashedFileName(const std::string &str) : HashedString(str) {}
 
 static SplittedPath return_and_set_error(bool *error)
@@ -101,7 +89,7 @@ SplittedPath absolute_path(const SplittedPath &path, const SplittedPath &base)
 }
 
 template < typename THashedString >
-SplittedString< THashedString >::SplittedString()
+SplittedString< THashedString >::SplittedString() : _separator(nullptr)
 {
     init();
 }
@@ -109,7 +97,7 @@ SplittedString< THashedString >::SplittedString()
 template < typename THashedString >
 SplittedString< THashedString >::SplittedString(const std::string &joint_,
                                                 const std::string &separator_)
-    : _joint(joint_), _separator(separator_)
+    : _joint(joint_), _separator(separatorRef(separator_))
 {
     init();
 }
@@ -117,7 +105,7 @@ SplittedString< THashedString >::SplittedString(const std::string &joint_,
 template < typename THashedString >
 SplittedString< THashedString >::SplittedString(
     const SplittedString::SplittedType &splitted_)
-    : _splitted(splitted_)
+    : _splitted(splitted_), _separator(nullptr)
 {
     init();
 }
@@ -148,11 +136,11 @@ template < typename THashedString >
 void SplittedString< THashedString >::appendPath(
     const SplittedString< THashedString > &extra_path)
 {
-    assert(_separator == extra_path._separator);
+    assert(*_separator == *extra_path._separator);
     if (joint().empty())
         _joint = extra_path.joint();
     else if (!extra_path.joint().empty())
-        _joint += _separator + extra_path._joint;
+        _joint += *_separator + extra_path._joint;
     clearSplitted();
 }
 
@@ -192,12 +180,11 @@ const THashedString &SplittedString< THashedString >::last() const
 template < typename THashedString >
 void SplittedString< THashedString >::setSeparator(const std::string &sep)
 {
-    if (_separator == sep)
+    if (*_separator == sep)
         return;
     if (_isJointValid && !_isSplittedValid)
         split();
-    _separator = sep;
-    _separatorSize = _separator.size();
+    _separator = separatorRef(sep);
     clearJoint();
 }
 
@@ -310,6 +297,29 @@ const THashedString &SplittedString< THashedString >::emptyString()
     return _e;
 }
 
+template < typename THashedString >
+size_t SplittedString< THashedString >::hash() const
+{
+    size_t result = 0;
+    for (const THashedString &s : splitted())
+        result ^= s.hash() + 0x9e3779b9 + (result << 6) + (result >> 2);
+    return result;
+}
+
+template < typename THashedString >
+const std::string *
+SplittedString< THashedString >::separatorRef(const std::string &sep)
+{
+    // the common separators don't need the symbol table
+    if (sep == unixSep())
+        return &unixSep();
+    if (sep == namespaceSep())
+        return &namespaceSep();
+    if (sep == osSep())
+        return &osSep();
+    return &SymbolTable::str(SymbolTable::intern(sep));
+}
+
 template < typename THashedString >
 void SplittedString< THashedString >::clearJoint()
 {
@@ -325,18 +335,19 @@ void SplittedString< THashedString >::join() const
     assert(!_isJointValid);
     size_t totalSize = 0;
     if (!_splitted.empty()) {
+        const size_t separatorSize = _separator->size();
         for (THashedString &sw : _splitted)
-            totalSize += sw.size() + _separatorSize;
-        totalSize -= _separatorSize;
+            totalSize += sw.size() + separatorSize;
+        totalSize -= separatorSize;
 
         _joint.reserve(totalSize);
         bool first = true;
         for (THashedString &sw : _splitted) {
             if (!first || sw.empty())
-                _joint += _separator;
+                _joint += *_separator;
             else
                 first = false;
-            _joint += sw;
+            _joint += sw.str();
         }
     }
 
@@ -361,11 +372,11 @@ void SplittedString< THashedString >::split() const
     if (_joint.empty())
         return;
     size_t pos = 0, sepPos;
-    while ((sepPos = _joint.find(_separator, pos)) !=
+    while ((sepPos = _joint.find(*_separator, pos)) !=
            static_cast< size_t >(-1)) {
         _splitted.push_back(_joint.substr(pos, sepPos - pos));
 
-        pos = sepPos + _separatorSize;
+        pos = sepPos + _separator->size();
     }
 
     std::string lastItem = _joint.substr(pos);
@@ -376,10 +387,8 @@ void SplittedString< THashedString >::split() const
 template < typename THashedString >
 void SplittedString< THashedString >::init()
 {
-    if (_separator.empty())
-        _separator = std::string("/");
-
-    _separatorSize = _separator.size();
+    if (!_separator || _separator->empty())
+        _separator = &unixSep();
 
     normalize();
 
@@ -406,9 +415,9 @@ void SplittedString< THashedString >::removeHomeDirSign()
 template < typename THashedString >
 void SplittedString< THashedString >::removeTrailingSeparators()
 {
-    while (_joint.find(_separator, _joint.size() - _separator.size()) !=
+    while (_joint.find(*_separator, _joint.size() - _separator->size()) !=
            static_cast< size_t >(-1)) {
-        _joint.resize(_joint.size() - _separator.size());
+        _joint.resize(_joint.size() - _separator->size());
     }
 }
 
@@ -2,6 +2,7 @@
 #define SPLITTED_STRING_HPP
 
 #include "extensions/help_functions.hpp"
+#include "types/symbol_table.hpp"
 
 #include <sstream>
 #include <iterator>
@@ -10,19 +11,30 @@
 
 const char *get_home_dir();
 
-class HashedString : public std::string
+// Interned string: holds the id of the string in the SymbolTable,
+// so copying, comparison and hashing are integer operations
+class HashedString
 {
 public:
-    using HashType = MurmurHashType;
+    using HashType = SymbolTable::Id;
 
 public:
-    HashedString(const std::string &str);
+    HashedString() : _id(SymbolTable::emptyId) {}
+    HashedString(const std::string &str) : _id(SymbolTable::intern(str)) {}
 
-    MurmurHashType hash() const;
+    const std::string &str() const { return SymbolTable::str(_id); }
+    operator const std::string &() const { return str(); }
+
+    const char *c_str() const { return str().c_str(); }
+    size_t size() const { return str().size(); }
+    bool empty() const { return _id == SymbolTable::emptyId; }
+
+    SymbolTable::Id id() const { return _id; }
+    HashType hash() const { return _id; }
 
     bool operator==(const HashedString &other) const
     {
-        return hash() == other.hash();
+        return _id == other._id;
     }
     bool operator!=(const HashedString &other) const
     {
@@ -30,19 +42,26 @@ public:
     }
 
 protected:
-    mutable MurmurHashType _hash;
+    SymbolTable::Id _id;
 };
 
+inline std::ostream &operator<<(std::ostream &os, const HashedString &hs)
+{
+    return os << hs.str();
+}
+
 class HashedFileName : public HashedString
 {
 public:
+    HashedFileName() {}
     HashedFileName(const std::string &str);
+    HashedFileName(const HashedString &hs) : HashedString(hs) {}
 
-    bool isDot() const { return hash() == _hashDot; }
-    bool isDotDot() const { return hash() == _hashDotDot; }
+    bool isDot() const { return _id == _idDot; }
+    bool isDotDot() const { return _id == _idDotDot; }
 
-    static const MurmurHashType _hashDot;
-    static const MurmurHashType _hashDotDot;
+    static const SymbolTable::Id _idDot;
+    static const SymbolTable::Id _idDotDot;
 };
 
 template < typename THashedString >
@@ -67,7 +86,7 @@ public:
     bool empty() const;
     bool isRelative() const;
 
-    const std::string &separator() const { return _separator; }
+    const std::string &separator() const { return *_separator; }
     void setSeparator(const std::string &sep);
 
     const std::string &joint() const;
@@ -105,6 +124,9 @@ public:
     static const std::string &unixSep();
     static const THashedString &emptyString();
 
+    // hash of the components, doesn't depend on the separator
+    size_t hash() const;
+
 private:
     void init();
     void join() const;
@@ -115,6 +137,8 @@ private:
     void removeHomeDirSign();
     void removeTrailingSeparators();
 
+    static const std::string *separatorRef(const std::string &sep);
+
 private:
     mutable bool _isJointValid;
     mutable bool _isSplittedValid;
@@ -123,8 +147,8 @@ protected:
     mutable std::string _joint;
     mutable SplittedType _splitted;
 
-    std::string _separator;
-    size_t _separatorSize;
+    // refers to a static or interned string
+    const std::string *_separator;
 };
 
 using ScopedName = SplittedString< HashedFileName >;
@@ -136,10 +160,7 @@ namespace std {
 template <>
 struct hash< ScopedName >
 {
-    size_t operator()(const ScopedName &o) const
-    {
-        return hash< std::string >{}(o.joint());
-    }
+    size_t operator()(const ScopedName &o) const { return o.hash(); }
 };
 } // namespace std
 
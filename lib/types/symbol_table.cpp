@@ -0,0 +1,109 @@
+#include "types/symbol_table.hpp"
+#include "extensions/help_functions.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+
+// refers to the string stored in the table, so a lookup doesn't allocate
+struct SymbolKey
+{
+    const char *data;
+    size_t size;
+    uint32_t hash;
+};
+
+struct SymbolKeyHash
+{
+    size_t operator()(const SymbolKey &key) const { return key.hash; }
+};
+
+struct SymbolKeyEqual
+{
+    bool operator()(const SymbolKey &lhs, const SymbolKey &rhs) const
+    {
+        return lhs.size == rhs.size &&
+               memcmp(lhs.data, rhs.data, lhs.size) == 0;
+    }
+};
+
+const size_t shardCount = 64;
+
+} // namespace
+
+// strings are distributed between shards by hash,
+// so threads interning different strings rarely wait for each other
+struct SymbolTable::Shard
+{
+    std::mutex mutex;
+    std::unordered_map< SymbolKey, Id, SymbolKeyHash, SymbolKeyEqual > ids;
+};
+
+SymbolTable::SymbolTable() : _nextId(0), _shards(new Shard[shardCount])
+{
+    for (auto &chunk : _chunks)
+        chunk.store(nullptr, std::memory_order_relaxed);
+
+    // the empty string goes first, so default constructed names get emptyId
+    uint32_t hash = MurmurHash2("", 0);
+    Id id = add(_shards[hash % shardCount], "", 0, hash);
+    assert(id == emptyId);
+    (void)id;
+}
+
+SymbolTable &SymbolTable::instance()
+{
+    // never destroyed: names in other static objects may outlive it
+    static SymbolTable *table = new SymbolTable;
+    return *table;
+}
+
+SymbolTable::Id SymbolTable::intern(const char *data, size_t size)
+{
+    SymbolTable &table = instance();
+    uint32_t hash = MurmurHash2(data, static_cast< int >(size));
+    Shard &shard = table._shards[hash % shardCount];
+
+    std::lock_guard< std::mutex > lock(shard.mutex);
+    auto it = shard.ids.find(SymbolKey{data, size, hash});
+    if (it != shard.ids.end())
+        return it->second;
+    return table.add(shard, data, size, hash);
+}
+
+size_t SymbolTable::size()
+{
+    return instance()._nextId.load(std::memory_order_relaxed);
+}
+
+SymbolTable::Id SymbolTable::add(Shard &shard, const char *data, size_t size,
+                                 uint32_t hash)
+{
+    Id id = _nextId.fetch_add(1, std::memory_order_relaxed);
+    std::string &slot = newSlot(id);
+    slot.assign(data, size);
+
+    shard.ids.emplace(SymbolKey{slot.data(), size, hash}, id);
+    return id;
+}
+
+std::string &SymbolTable::newSlot(Id id)
+{
+    const size_t chunkIndex = id >> chunkBits;
+    assert(chunkIndex < maxChunks);
+
+    std::string *chunk = _chunks[chunkIndex].load(std::memory_order_acquire);
+    if (!chunk) {
+        // chunks are never moved, so str() may read them without a lock
+        std::string *fresh = new std::string[size_t(1) << chunkBits];
+        if (_chunks[chunkIndex].compare_exchange_strong(
+                chunk, fresh, std::memory_order_acq_rel))
+            chunk = fresh;
+        else
+            delete[] fresh;
+    }
+    return chunk[id & chunkMask];
+}
@@ -0,0 +1,55 @@
+#ifndef SYMBOL_TABLE_HPP
+#define SYMBOL_TABLE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Global string interner: every distinct string is stored once and is
+// referred to by a 32-bit id, so equal strings have equal ids.
+// intern() may be called from several threads. str() doesn't lock,
+// stored strings never move.
+class SymbolTable
+{
+public:
+    using Id = uint32_t;
+
+    // id of the empty string
+    static const Id emptyId = 0;
+
+    static Id intern(const char *data, size_t size);
+    static Id intern(const std::string &str)
+    {
+        return intern(str.data(), str.size());
+    }
+
+    static const std::string &str(Id id)
+    {
+        const std::string *chunk =
+            instance()._chunks[id >> chunkBits].load(std::memory_order_acquire);
+        return chunk[id & chunkMask];
+    }
+
+    static size_t size();
+
+private:
+    static const unsigned chunkBits = 12;
+    static const Id chunkMask = (Id(1) << chunkBits) - 1;
+    static const size_t maxChunks = size_t(1) << 16;
+
+    struct Shard;
+
+    SymbolTable();
+
+    static SymbolTable &instance();
+
+    Id add(Shard &shard, const char *data, size_t size, uint32_t hash);
+    std::string &newSlot(Id id);
+
+    std::atomic< std::string * > _chunks[maxChunks];
+    std::atomic< Id > _nextId;
+    std::unique_ptr< Shard[] > _shards;
+};
+
+#endif // SYMBOL_TABLE_HPP
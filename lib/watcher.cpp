@@ -0,0 +1,278 @@
+#include "watcher.hpp"
+#include "command_line_args.hpp"
+#include "extensions/error_reporter.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+Watcher::Watcher(const CommandLineArgs &clargs)
+    : _clargs(clargs), _resident(clargs), _inotify(-1), _outDevice(0),
+      _outInode(0)
+{
+}
+
+Watcher::~Watcher()
+{
+#ifdef __linux__
+    if (_inotify >= 0)
+        close(_inotify);
+#endif
+}
+
+void Watcher::rememberUnchanged()
+{
+    const FileNode *root = _resident.tree().rootNode();
+    if (!root)
+        return;
+    for (const FileNode *file : root->getFiles()) {
+        if (file->isModified())
+            continue;
+        const ContentHasher::HashArray &hash = file->record()._hashArray;
+        _unchanged.emplace(
+            file->name(),
+            std::string(reinterpret_cast< const char * >(hash),
+                        ContentHasher::hashSize));
+    }
+}
+
+void Watcher::update()
+{
+    FileTree &tree = _resident.tree();
+    std::vector< FileNode * > changedFiles;
+    if (tree.rootNode()) {
+        for (FileNode *file : tree.rootNode()->getFiles()) {
+            auto it = _unchanged.find(file->name());
+            if (it == _unchanged.end() ||
+                memcmp(it->second.data(), file->record()._hashArray,
+                       ContentHasher::hashSize) != 0)
+                changedFiles.push_back(file);
+        }
+    }
+    tree.writeAffectedFiles(_clargs, changedFiles);
+}
+
+bool Watcher::isIgnored(const SplittedPath &path) const
+{
+    return _ignored.matches(path.jointUnix());
+}
+
+void Watcher::touch(const SplittedPath &path)
+{
+    bool error = false;
+    SplittedPath relative =
+        relative_path(path, _clargs.rootDirectory(), &error);
+    if (!error)
+        _touched.push_back(std::move(relative));
+}
+
+#ifndef __linux__
+int Watcher::run()
+{
+    errors() << "error: --watch needs inotify";
+    return 1;
+}
+
+void Watcher::watchDirectory(const SplittedPath &,
+                             std::vector< SplittedPath > *)
+{
+}
+
+bool Watcher::isOutDir(const SplittedPath &) const { return false; }
+
+bool Watcher::readEvents() { return false; }
+#else // Linux
+namespace {
+
+const uint32_t watchMask = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+                           IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+// a save is several events (editors write a copy and rename it),
+// the output is updated when no event came for this long
+const int settleMs = 20;
+
+} // namespace
+
+bool Watcher::isOutDir(const SplittedPath &path) const
+{
+    struct stat st;
+    return stat(path.jointOs().c_str(), &st) == 0 &&
+           static_cast< uint64_t >(st.st_dev) == _outDevice &&
+           static_cast< uint64_t >(st.st_ino) == _outInode;
+}
+
+void Watcher::watchDirectory(const SplittedPath &path,
+                             std::vector< SplittedPath > *files)
+{
+    if (isIgnored(path))
+        return;
+    if (!is_directory(path)) {
+        if (files)
+            files->push_back(path);
+        return;
+    }
+    if (isOutDir(path))
+        return;
+
+    const int wd = inotify_add_watch(_inotify, path.jointOs().c_str(),
+                                     watchMask);
+    if (wd < 0) {
+        errors() << "warning: can't watch" << path.joint() << ":"
+                 << strerror(errno);
+        return;
+    }
+    _directories[wd] = path;
+
+    DIR *dir = opendir(path.jointOs().c_str());
+    if (!dir)
+        return;
+    while (const dirent *entry = readdir(dir)) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+            continue;
+        if (entry->d_type == DT_DIR || entry->d_type == DT_UNKNOWN || files)
+            watchDirectory(
+                path + SplittedPath(entry->d_name, SplittedPath::osSep()),
+                files);
+    }
+    closedir(dir);
+}
+
+bool Watcher::readEvents()
+{
+    bool relevant = false;
+    alignas(inotify_event) char buffer[64 * 1024];
+    for (;;) {
+        const ssize_t count = read(_inotify, buffer, sizeof(buffer));
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+            return relevant; // EAGAIN, everything is read
+
+        for (const char *p = buffer; p < buffer + count;) {
+            const inotify_event *event =
+                reinterpret_cast< const inotify_event * >(p);
+            p += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                // events are lost: every file is hashed again, those of
+                // the tree and those found watching the directories anew
+                std::vector< SplittedPath > files;
+                for (const SplittedPath &dir : _clargs.srcDirectories())
+                    watchDirectory(_clargs.rootDirectory() + dir, &files);
+                for (const SplittedPath &dir : _clargs.testDirectories())
+                    watchDirectory(_clargs.rootDirectory() + dir, &files);
+                for (const SplittedPath &file : files)
+                    touch(file);
+                if (_resident.isBuilt()) {
+                    for (const FileNode *file :
+                         _resident.tree().rootNode()->getFiles())
+                        _touched.push_back(file->path());
+                }
+                relevant = true;
+                continue;
+            }
+            auto it = _directories.find(event->wd);
+            if (it == _directories.end())
+                continue;
+            if (event->mask & IN_IGNORED) {
+                // the directory is removed
+                _directories.erase(it);
+                continue;
+            }
+            if (!event->len)
+                continue;
+
+            const SplittedPath path =
+                it->second + SplittedPath(event->name, SplittedPath::osSep());
+            if (isIgnored(path))
+                continue;
+            if (!(event->mask & IN_ISDIR)) {
+                touch(path);
+            }
+            else if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                // its files, created before the watch is added, may take
+                // the place of files of the tree
+                std::vector< SplittedPath > files;
+                watchDirectory(path, &files);
+                for (const SplittedPath &file : files)
+                    touch(file);
+            }
+            else {
+                // deleted or moved away, its files are dropped
+                touch(path);
+            }
+            relevant = true;
+        }
+    }
+}
+
+int Watcher::run()
+{
+    _inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (_inotify < 0) {
+        errors() << "error: inotify_init1():" << strerror(errno);
+        return 1;
+    }
+    _ignored = SubstringMatcher(_clargs.ignoredSubstrings());
+
+    create_directories(_clargs.outDir());
+    struct stat outStat;
+    if (stat(_clargs.outDir().jointOs().c_str(), &outStat) == 0) {
+        _outDevice = outStat.st_dev;
+        _outInode = outStat.st_ino;
+    }
+
+    // before the first refresh, so changes made during it aren't missed
+    for (const SplittedPath &dir : _clargs.srcDirectories())
+        watchDirectory(_clargs.rootDirectory() + dir);
+    for (const SplittedPath &dir : _clargs.testDirectories())
+        watchDirectory(_clargs.rootDirectory() + dir);
+
+    _resident.refresh();
+    rememberUnchanged();
+    update();
+
+    if (_clargs.verbal())
+        std::cout << "watching " << _directories.size() << " directories"
+                  << std::endl;
+
+    pollfd pfd;
+    pfd.fd = _inotify;
+    pfd.events = POLLIN;
+    for (;;) {
+        if (poll(&pfd, 1, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            errors() << "error: poll():" << strerror(errno);
+            return 1;
+        }
+        bool relevant = readEvents();
+        while (poll(&pfd, 1, settleMs) > 0)
+            relevant = readEvents() || relevant;
+        if (!relevant)
+            continue;
+
+        const auto start = std::chrono::steady_clock::now();
+        _resident.refresh(_touched);
+        _touched.clear();
+        update();
+        if (_clargs.verbal()) {
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            std::cout << "updated in "
+                      << std::chrono::duration_cast<
+                             std::chrono::milliseconds >(elapsed)
+                             .count()
+                      << " ms" << std::endl;
+        }
+    }
+}
+#endif
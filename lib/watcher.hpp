@@ -0,0 +1,65 @@
+#ifndef WATCHER_HPP
+#define WATCHER_HPP
+
+#include "extensions/help_functions.hpp"
+#include "extensions/string_matchers.hpp"
+#include "resident_tree.hpp"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class CommandLineArgs;
+
+// Keeps the affected files up to date while the sources are edited.
+// inotify reports the changes in the source and test directories; once
+// they settle, they are applied to the resident tree in place: only the
+// files the events named are hashed again and, if their contents changed,
+// parsed, and the affected files are written again. Files
+// count as changed if they were modified when the watch started or their
+// content differs from what it was then, so the output is what a run
+// against the same --ftree-in would write.
+class Watcher
+{
+public:
+    explicit Watcher(const CommandLineArgs &clargs);
+    ~Watcher();
+
+    // watches until the process is killed
+    int run();
+
+private:
+    void update();
+    void rememberUnchanged();
+
+    // watches the directory and its subdirectories; the files found under
+    // it are appended to files, if given
+    void watchDirectory(const SplittedPath &path,
+                        std::vector< SplittedPath > *files = nullptr);
+    // true if some event may change the output
+    bool readEvents();
+    bool isIgnored(const SplittedPath &path) const;
+    bool isOutDir(const SplittedPath &path) const;
+    // the file is read again, or dropped, by the next refresh
+    void touch(const SplittedPath &path);
+
+    const CommandLineArgs &_clargs;
+    ResidentTree _resident;
+
+    SubstringMatcher _ignored;
+    int _inotify;
+    // the output directory isn't watched, writing the output
+    // mustn't wake the watcher
+    uint64_t _outDevice;
+    uint64_t _outInode;
+    // watch descriptor -> watched directory
+    std::unordered_map< int, SplittedPath > _directories;
+    // files and removed directories named by the events since the last
+    // refresh, relative to the root
+    std::vector< SplittedPath > _touched;
+    // hashes of the files unmodified when the watch started
+    std::unordered_map< std::string, std::string > _unchanged;
+};
+
+#endif // WATCHER_HPP
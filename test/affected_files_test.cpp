@@ -0,0 +1,90 @@
+#include "affected_files_test.h"
+#include "dependency_graph.h"
+
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+struct Case
+{
+    const char *name;
+    const char *edges;
+    // separated by spaces
+    const char *modified;
+    const char *labeled;
+};
+
+const Case cases[] = {
+    {"header in a cycle",
+     "a.cpp>a.h a.h>b.h b.h>c.h c.h>a.h d.cpp>c.h e.cpp>d.cpp f.cpp>f.h",
+     "b.h", ""},
+    {"implementation in a cycle",
+     "a.h>a.cpp a.cpp>a.h b.cpp>a.h c.h>c.cpp", "a.cpp", ""},
+    {"non-source header in a cycle",
+     "n.cpp>x.inl x.inl>y.h y.h>x.inl m.cpp>y.h k.cpp>k.h", "x.inl", ""},
+    {"self include", "s.h>s.h s.cpp>s.h t.cpp>t.h", "s.h", ""},
+    {"labeled test", "test.cpp>a.h a.h>b.h b.h>a.h c.cpp>b.h d.cpp>d.h", "",
+     "test.cpp"},
+    {"nested cycles",
+     "a.h>b.h b.h>a.h b.h>c.h c.h>d.h d.h>c.h d.h>a.h e.cpp>d.h f.h>e.cpp "
+     "g.cpp>a.h",
+     "c.h", ""},
+};
+
+// FileNode::isAffected() before the walk from the affected files
+bool referenceAffected(const DependencyGraph &graph, FileNode *file)
+{
+    for (FileNode *dep : graph.referenceDependencies(file)) {
+        if (dep->isThisAffected())
+            return true;
+    }
+    for (FileNode *dep : graph.referenceDependentBy(file)) {
+        if (dep->isThisAffected())
+            return true;
+    }
+    return false;
+}
+
+int check(const std::string &name, DependencyGraph &graph)
+{
+    graph.tree().installAffectedFiles();
+
+    DependencyGraph::FileSet affected, expected;
+    for (FileNode *file : graph.files()) {
+        if (file->isAffected())
+            affected.insert(file);
+        if (referenceAffected(graph, file))
+            expected.insert(file);
+    }
+    if (affected == expected)
+        return 0;
+    std::cout << "FAIL " << name << ": affected" << toString(affected)
+              << ", expected" << toString(expected) << std::endl;
+    return 1;
+}
+
+} // namespace
+
+int testAffectedFiles()
+{
+    int failures = 0;
+    for (const Case &c : cases) {
+        DependencyGraph graph(c.edges);
+        std::string name;
+        for (std::istringstream is(c.modified); is >> name;)
+            graph.file(name)->setModified();
+        for (std::istringstream is(c.labeled); is >> name;)
+            graph.file(name)->setLabeled();
+        failures += check(c.name, graph);
+    }
+    for (unsigned seed = 1; seed <= 20; ++seed) {
+        DependencyGraph graph(seed, 60, 90);
+        // a few modified and labeled files, cycles are common at this density
+        for (size_t i = seed % 7; i < graph.files().size(); i += 17)
+            graph.files()[i]->setModified();
+        graph.files()[seed % graph.files().size()]->setLabeled();
+        failures += check("random graph " + std::to_string(seed), graph);
+    }
+    return failures;
+}
@@ -0,0 +1,8 @@
+#ifndef AFFECTED_FILES_TEST_H
+#define AFFECTED_FILES_TEST_H
+
+// FileTree::installAffectedFiles() against the per-file check it replaced;
+// returns the number of failed cases
+int testAffectedFiles();
+
+#endif // AFFECTED_FILES_TEST_H
@@ -0,0 +1,113 @@
+#include "changed_files_reader_test.h"
+
+#include <changed_files_reader.hpp>
+#include <extensions/help_functions.hpp>
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::string root = "changed_files_fixtures";
+
+void writeFile(const std::string &path, const char *text)
+{
+    std::ofstream ofs(root + '/' + path, std::ios::binary);
+    ofs << text;
+}
+
+bool run(const std::string &command)
+{
+    return std::system(("cd " + root + " && " + command + " >/dev/null 2>&1")
+                           .c_str()) == 0;
+}
+
+struct Case
+{
+    const char *name;
+    // a list file or a revision
+    std::string source;
+    // relative to the fixtures
+    std::string root;
+    bool isRead;
+    std::set< std::string > paths;
+};
+
+std::string toString(const std::set< std::string > &paths)
+{
+    std::string result;
+    for (const std::string &path : paths)
+        result += ' ' + path;
+    return result.empty() ? " (none)" : result;
+}
+
+int check(const Case &c)
+{
+    // the paths given are kept, the read ones are appended
+    std::vector< SplittedPath > paths(
+        1, SplittedPath("given", SplittedPath::unixSep()));
+    const bool isRead = ChangedFilesReader().read(
+        c.source, SplittedPath(root + '/' + c.root, SplittedPath::unixSep()),
+        paths);
+
+    std::set< std::string > read;
+    for (size_t i = 1; i < paths.size(); ++i)
+        read.insert(paths[i].jointUnix());
+    if (isRead == c.isRead && read == c.paths && !paths.empty() &&
+        paths.front().jointUnix() == "given")
+        return 0;
+    std::cout << "FAIL " << c.name << ": " << (isRead ? "read" : "not read")
+              << toString(read) << ", expected "
+              << (c.isRead ? "read" : "not read") << toString(c.paths)
+              << std::endl;
+    return 1;
+}
+
+} // namespace
+
+int testChangedFilesReader()
+{
+    create_directories(root + "/sub");
+    int failures = 0;
+
+    writeFile("list.txt", "a.cpp\r\n\nsub/b.h\n");
+    failures += check({"list", root + "/list.txt", "", true,
+                       {"a.cpp", "sub/b.h"}});
+    failures += check({"option", "-x", "", false, {}});
+    failures += check({"empty", "", "", false, {}});
+
+    if (!run("git --version")) {
+        std::cout << "SKIP changed files from git: no git" << std::endl;
+        return failures;
+    }
+    // a repository of its own, whatever the tree it is in
+    std::system(("rm -rf " + root + "/.git").c_str());
+    writeFile("a.cpp", "int a;\n");
+    writeFile("c.cpp", "int c;\n");
+    writeFile("sub/b.h", "int b;\n");
+    writeFile("sub/d.h", "int d;\n");
+    if (!run("git init -q . && git add a.cpp c.cpp sub/b.h sub/d.h && "
+             "git -c user.name=t -c user.email=t@t commit -q -m base")) {
+        std::cout << "FAIL git: can't make the repository" << std::endl;
+        return failures + 1;
+    }
+    writeFile("a.cpp", "int a = 1;\n");
+    writeFile("sub/b.h", "int b = 1;\n");
+    writeFile("sub/e.h", "int e;\n");
+    run("git rm -q c.cpp");
+
+    // modified, removed and untracked files; list.txt isn't tracked either
+    failures += check({"revision", "HEAD", "", true,
+                       {"a.cpp", "c.cpp", "sub/b.h", "sub/e.h", "list.txt"}});
+    failures += check({"subdirectory", "HEAD", "sub", true,
+                       {"b.h", "e.h"}});
+    // git fails, that isn't an empty change set
+    failures += check({"bad revision", "no-such-revision", "", false, {}});
+    failures += check({"not a repository", "HEAD", "../no-such-dir", false,
+                       {}});
+    return failures;
+}
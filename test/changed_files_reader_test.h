@@ -0,0 +1,9 @@
+#ifndef CHANGED_FILES_READER_TEST_H
+#define CHANGED_FILES_READER_TEST_H
+
+// ChangedFilesReader on a list file and on revisions of a git repository
+// made for the test, a bad revision included; returns the number of
+// failed cases
+int testChangedFilesReader();
+
+#endif // CHANGED_FILES_READER_TEST_H
@@ -0,0 +1,74 @@
+#include "dependency_closure_test.h"
+#include "dependency_graph.h"
+
+#include <iostream>
+
+namespace {
+
+struct Case
+{
+    const char *name;
+    const char *edges;
+};
+
+const Case cases[] = {
+    {"cycle", "a.cpp>a.h a.h>b.h b.h>c.h c.h>a.h d.cpp>c.h e.cpp>d.cpp"},
+    {"self include", "s.h>s.h s.cpp>s.h t.cpp>t.cpp"},
+    {"diamond", "t.cpp>l.h t.cpp>r.h l.h>base.h r.h>base.h base.cpp>base.h"},
+    {"non-source headers",
+     "n.cpp>x.inl x.inl>y.h y.h>z.inl p.h>q.inl q.inl>p.h m.cpp>q.inl"},
+    {"nested cycles",
+     "a.h>b.h b.h>a.h b.h>c.h c.h>d.h d.h>c.h d.h>a.h e.cpp>d.h f.h>e.cpp"},
+    {"isolated", "lonely.cpp lonely.inl"},
+};
+
+DependencyGraph::FileSet toSet(const std::vector< FileNode * > &files)
+{
+    return DependencyGraph::FileSet(files.begin(), files.end());
+}
+
+int check(const char *name, DependencyGraph &graph)
+{
+    int failures = 0;
+    for (FileNode *file : graph.files()) {
+        const DependencyGraph::FileSet dependencies =
+            toSet(file->dependencies());
+        const DependencyGraph::FileSet dependentBy = toSet(file->dependentBy());
+        const DependencyGraph::FileSet expectedDependencies =
+            graph.referenceDependencies(file);
+        const DependencyGraph::FileSet expectedDependentBy =
+            graph.referenceDependentBy(file);
+        if (dependencies != expectedDependencies) {
+            std::cout << "FAIL " << name << ": " << file->name()
+                      << " depends on" << toString(dependencies)
+                      << ", expected" << toString(expectedDependencies)
+                      << std::endl;
+            ++failures;
+        }
+        if (dependentBy != expectedDependentBy) {
+            std::cout << "FAIL " << name << ": " << file->name()
+                      << " is dependent by" << toString(dependentBy)
+                      << ", expected" << toString(expectedDependentBy)
+                      << std::endl;
+            ++failures;
+        }
+    }
+    return failures;
+}
+
+} // namespace
+
+int testDependencyClosure()
+{
+    int failures = 0;
+    for (const Case &c : cases) {
+        DependencyGraph graph(c.edges);
+        failures += check(c.name, graph);
+    }
+    for (unsigned seed = 1; seed <= 20; ++seed) {
+        DependencyGraph graph(seed, 60, 90);
+        const std::string name = "random graph " + std::to_string(seed);
+        failures += check(name.c_str(), graph);
+    }
+    return failures;
+}
@@ -0,0 +1,8 @@
+#ifndef DEPENDENCY_CLOSURE_TEST_H
+#define DEPENDENCY_CLOSURE_TEST_H
+
+// DependencyClosure against the recursive closures it replaced; returns
+// the number of failed cases
+int testDependencyClosure();
+
+#endif // DEPENDENCY_CLOSURE_TEST_H
@@ -0,0 +1,106 @@
+#include "dependency_graph.h"
+
+#include <sstream>
+
+DependencyGraph::DependencyGraph(const std::string &edges)
+    : _tree(new FileTree)
+{
+    _tree->setRootPath(SplittedPath("graph", SplittedPath::unixSep()));
+
+    std::istringstream is(edges);
+    std::string edge;
+    while (is >> edge) {
+        const size_t arrow = edge.find('>');
+        FileNode *from = file(edge.substr(0, arrow));
+        if (arrow != std::string::npos)
+            from->addExplicitDep(file(edge.substr(arrow + 1)));
+    }
+    computeReference();
+}
+
+DependencyGraph::DependencyGraph(unsigned seed, int fileCount, int edgeCount)
+    : _tree(new FileTree)
+{
+    _tree->setRootPath(SplittedPath("graph", SplittedPath::unixSep()));
+
+    // the same graph on every platform
+    auto random = [&seed](int bound) {
+        seed = seed * 1103515245u + 12345u;
+        return static_cast< int >((seed >> 16) % bound);
+    };
+    for (int i = 0; i < fileCount; ++i) {
+        static const char *const extensions[] = {".cpp", ".h", ".h", ".inl"};
+        file("f" + std::to_string(i) + extensions[random(4)]);
+    }
+    for (int i = 0; i < edgeCount; ++i)
+        _files[random(fileCount)]->addExplicitDep(_files[random(fileCount)]);
+    computeReference();
+}
+
+FileNode *DependencyGraph::file(const std::string &name)
+{
+    FileNode *&node = _byName[name];
+    if (!node) {
+        node = _tree->rootNode()->newChild(HashedFileName(name),
+                                           FileRecord::RegularFile);
+        if (extension(name) != ".inl") {
+            node->setSourceFile();
+            _sources.push_back(node);
+        }
+        _files.push_back(node);
+    }
+    return node;
+}
+
+DependencyGraph::FileSet
+DependencyGraph::referenceDependencies(FileNode *node) const
+{
+    auto it = _dependencies.find(node);
+    return it != _dependencies.end() ? it->second : FileSet();
+}
+
+DependencyGraph::FileSet
+DependencyGraph::referenceDependentBy(FileNode *node) const
+{
+    auto it = _dependentBy.find(node);
+    return it != _dependentBy.end() ? it->second : FileSet();
+}
+
+void DependencyGraph::computeReference()
+{
+    for (FileNode *source : _sources) {
+        FileSet visited;
+        FileSet &result = _dependencies[source];
+        installDependencies(source, source, visited, result);
+        // a file always depends on itself
+        result.insert(source);
+
+        for (FileNode *dep : result)
+            _dependentBy[dep].insert(source);
+    }
+}
+
+// FileNode::installDependenciesR()
+void DependencyGraph::installDependencies(FileNode *source, FileNode *node,
+                                          FileSet &visited, FileSet &result)
+{
+    if (!visited.insert(node).second)
+        return;
+    auto installed = _dependencies.find(node);
+    if (node != source && installed != _dependencies.end()) {
+        result.insert(installed->second.begin(), installed->second.end());
+        return;
+    }
+    result.insert(node->_setExplicitDependencies.begin(),
+                  node->_setExplicitDependencies.end());
+    for (FileNode *dep : node->_setExplicitDependencies)
+        installDependencies(source, dep, visited, result);
+}
+
+std::string toString(const DependencyGraph::FileSet &files)
+{
+    std::string result;
+    for (FileNode *file : files)
+        result += ' ' + file->name();
+    return result.empty() ? " (none)" : result;
+}
@@ -0,0 +1,51 @@
+#ifndef DEPENDENCY_GRAPH_H
+#define DEPENDENCY_GRAPH_H
+
+#include <types/file_tree.hpp>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+// A file tree built in memory from the explicit dependencies of its files,
+// for the tests of the dependency closure and of the affected files.
+// Files are source files unless their extension is .inl.
+class DependencyGraph
+{
+public:
+    using FileSet = std::set< FileNode * >;
+
+    // "from>to" pairs separated by spaces, e.g. "a.cpp>a.h a.h>b.h"
+    explicit DependencyGraph(const std::string &edges);
+    // n files with random explicit dependencies
+    DependencyGraph(unsigned seed, int fileCount, int edgeCount);
+
+    FileTree &tree() { return *_tree; }
+    FileNode *file(const std::string &name);
+    const std::vector< FileNode * > &files() const { return _files; }
+
+    // the closures as FileNode::installDependencies() built them before
+    // DependencyClosure: a recursive walk from every source file, in the
+    // order they were labeled, reusing the closures of the files done
+    FileSet referenceDependencies(FileNode *node) const;
+    FileSet referenceDependentBy(FileNode *node) const;
+
+private:
+    void computeReference();
+    void installDependencies(FileNode *source, FileNode *node,
+                             FileSet &visited, FileSet &result);
+
+    std::unique_ptr< FileTree > _tree;
+    std::map< std::string, FileNode * > _byName;
+    std::vector< FileNode * > _files;
+    std::vector< FileNode * > _sources;
+
+    std::map< FileNode *, FileSet > _dependencies;
+    std::map< FileNode *, FileSet > _dependentBy;
+};
+
+std::string toString(const DependencyGraph::FileSet &files);
+
+#endif // DEPENDENCY_GRAPH_H
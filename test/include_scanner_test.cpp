@@ -0,0 +1,174 @@
+#include "include_scanner_test.h"
+
+#include <extensions/help_functions.hpp>
+#include <parsers/include_scanner.hpp>
+#include <parsers/sourceparser.hpp>
+#include <types/file_tree.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Fixture
+{
+    const char *name;
+    const char *text;
+    // false if the file is to be parsed in full
+    bool isScanned;
+    // the directives found, where the file is scanned
+    std::vector< IncludeDirective > includes;
+};
+
+IncludeDirective quotes(const char *filename)
+{
+    return IncludeDirective(filename);
+}
+
+IncludeDirective brackets(const char *filename)
+{
+    IncludeDirective dir(filename);
+    dir.type = IncludeDirective::Brackets;
+    return dir;
+}
+
+// every included file exists, so the parser keeps every directive it finds
+const char *const headers[] = {"inc.h", "x.h", "y.h", "z.h", "a/b.h"};
+
+const Fixture fixtures[] = {
+    {"comments.cpp",
+     "#include \"inc.h\"\n"
+     "/* #include \"x.h\"\n"
+     "#include \"y.h\" */\n"
+     "// #include \"z.h\"\n"
+     "int a = 1; /* a */ int b = 2;\n",
+     true,
+     {quotes("inc.h")}},
+    {"strings.cpp",
+     "const char *s = \"#include \\\"x.h\\\"\";\n"
+     "const char *t = \"\\\"\\n#include <y.h>\";\n"
+     "#include \"inc.h\"\n",
+     true,
+     {quotes("inc.h")}},
+    {"else.cpp",
+     "#ifdef A\n"
+     "#include \"inc.h\"\n"
+     "#elif B\n"
+     "#include \"x.h\"\n"
+     "#else\n"
+     "#include \"y.h\"\n"
+     "#endif\n"
+     "#ifndef C\n"
+     "#include \"a/b.h\"\n"
+     "#else\n"
+     "#ifdef D\n"
+     "#include \"x.h\"\n"
+     "#endif\n"
+     "#endif\n"
+     "#include \"z.h\"\n",
+     true,
+     {quotes("inc.h"), quotes("a/b.h"), quotes("z.h")}},
+    {"continuation.cpp",
+     "#define X 1 \\\n"
+     "#include \"x.h\"\n"
+     "#include \"inc.h\"\n"
+     "#define Y \\\n"
+     "    2 \\\n"
+     "#include <z.h>\n"
+     "#include \"y.h\" \\\n"
+     "#include \"z.h\"\n",
+     true,
+     {quotes("inc.h"), quotes("y.h")}},
+    // the parser warns about the directive
+    {"broken_include.cpp", "#include \\\n\"inc.h\"\n", false, {}},
+    {"brackets.cpp",
+     "#include <a/b.h>\n"
+     "#include <inc.h>\n"
+     "#include \"a/b.h\"\n",
+     true,
+     {brackets("a/b.h"), brackets("inc.h"), quotes("a/b.h")}},
+    {"class.cpp", "#include \"inc.h\"\nclass A;\n", false, {}},
+    {"struct.h", "#include \"inc.h\"\nstruct A { int a; };\n", false, {}},
+    {"function.cpp", "#include \"inc.h\"\nint f(int a);\n", false, {}},
+    {"scope.cpp", "#include \"inc.h\"\nint a = B::c;\n", false, {}},
+};
+
+void writeFile(const std::string &path, const char *text)
+{
+    std::ofstream ofs(path, std::ios::binary);
+    ofs << text;
+}
+
+bool sameIncludes(const std::vector< IncludeDirective > &lhs,
+                  const std::vector< IncludeDirective > &rhs)
+{
+    if (lhs.size() != rhs.size())
+        return false;
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        if (lhs[i].type != rhs[i].type || lhs[i].filename != rhs[i].filename)
+            return false;
+    }
+    return true;
+}
+
+std::string toString(const std::vector< IncludeDirective > &includes)
+{
+    std::string result;
+    for (const IncludeDirective &dir : includes)
+        result += (dir.isQuotes() ? " \"" : " <") + dir.filename +
+                  (dir.isQuotes() ? "\"" : ">");
+    return result.empty() ? " (none)" : result;
+}
+
+} // namespace
+
+int testIncludeScanner()
+{
+    // the parser takes the directives from the files of a tree
+    const std::string root = "include_scanner_fixtures";
+    create_directories(root + "/a");
+    for (const char *header : headers)
+        writeFile(root + '/' + header, "");
+    for (const Fixture &fixture : fixtures)
+        writeFile(root + '/' + fixture.name, fixture.text);
+
+    FileTree tree;
+    tree.setRootPath(SplittedPath(root, SplittedPath::unixSep()));
+    tree.readSources({SplittedPath()}, {});
+    SourceParser parser(tree);
+    IncludeScanner scanner;
+
+    int failures = 0;
+    for (const Fixture &fixture : fixtures) {
+        FileNode *node = tree.searchInRoot(
+            SplittedPath(fixture.name, SplittedPath::unixSep()));
+        if (!node) {
+            std::cout << "FAIL " << fixture.name << ": not read" << std::endl;
+            ++failures;
+            continue;
+        }
+        parser.parseFile(node);
+        const std::vector< IncludeDirective > &parsed =
+            node->record()._listIncludes;
+
+        std::vector< IncludeDirective > scanned;
+        const std::string text(fixture.text);
+        const bool isScanned = scanner.scan(text.data(), text.size(), scanned);
+        if (isScanned != fixture.isScanned) {
+            std::cout << "FAIL " << fixture.name << ": "
+                      << (isScanned ? "scanned" : "not scanned") << std::endl;
+            ++failures;
+        }
+        else if (isScanned && (!sameIncludes(scanned, parsed) ||
+                               !sameIncludes(scanned, fixture.includes))) {
+            std::cout << "FAIL " << fixture.name
+                      << ": scanned" << toString(scanned) << ", parsed"
+                      << toString(parsed) << ", expected"
+                      << toString(fixture.includes) << std::endl;
+            ++failures;
+        }
+    }
+    return failures;
+}
@@ -0,0 +1,8 @@
+#ifndef INCLUDE_SCANNER_TEST_H
+#define INCLUDE_SCANNER_TEST_H
+
+// IncludeScanner::scan() against the include directives SourceParser finds
+// in the same text; returns the number of failed cases
+int testIncludeScanner();
+
+#endif // INCLUDE_SCANNER_TEST_H
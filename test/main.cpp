@@ -2,9 +2,24 @@
 
 #include <parsers/tokenizer.hpp>
 
+#include "affected_files_test.h"
+#include "changed_files_reader_test.h"
+#include "dependency_closure_test.h"
+#include "include_scanner_test.h"
+#include "resident_tree_test.h"
+#include "tokenizer_test.h"
+
 int main(int argc, char **argv)
 {
     std::cout << "TESTING" << std::endl;
 
-    return 0;
+    int failures = 0;
+    failures += testAffectedFiles();
+    failures += testChangedFilesReader();
+    failures += testDependencyClosure();
+    failures += testIncludeScanner();
+    failures += testResidentTree();
+    failures += testTokenizer();
+
+    return failures ? 1 : 0;
 }
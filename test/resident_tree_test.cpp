@@ -0,0 +1,176 @@
+#include "resident_tree_test.h"
+
+#include <command_line_args.hpp>
+#include <extensions/help_functions.hpp>
+#include <resident_tree.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::string root = "resident_tree_fixtures";
+
+void writeFile(const std::string &path, const char *text)
+{
+    std::ofstream ofs(root + '/' + path, std::ios::binary);
+    ofs << text;
+}
+
+void removeFile(const std::string &path)
+{
+    std::remove((root + '/' + path).c_str());
+}
+
+struct Step
+{
+    const char *name;
+    // changes the files
+    void (*change)();
+    // the changed paths, relative to the root
+    std::vector< std::string > paths;
+};
+
+const Step steps[] = {
+    {"unchanged", [] {}, {"src/a.cpp", "src/c.h"}},
+    {"body",
+     [] { writeFile("src/a.cpp", "#include \"a.h\"\nvoid A::f() {}\n"); },
+     {"src/a.cpp"}},
+    // a.h includes it, the edge is kept
+    {"implementation gone",
+     [] { writeFile("src/a.tpp", "int t() { return 0; }\n"); },
+     {"src/a.tpp"}},
+    {"added",
+     [] {
+         writeFile("src/d.h", "#include \"c.h\"\n");
+         writeFile("test/t_a.cpp", "#include \"src/b.h\"\n"
+                                   "#include \"src/d.h\"\n"
+                                   "int main() { return 0; }\n");
+     },
+     {"src/d.h", "test/t_a.cpp"}},
+    {"removed", [] { removeFile("src/b.h"); }, {"src/b.h"}},
+    // h.cpp implements h(), declared now
+    {"declarations",
+     [] {
+         writeFile("src/c.h", "int h();\nclass C {};\n");
+         writeFile("src/c.cpp", "#include \"c.h\"\nclass C;\n");
+     },
+     {"src/c.h", "src/c.cpp"}},
+    {"directory removed",
+     [] {
+         removeFile("src/sub/e.h");
+         removeFile("src/sub");
+     },
+     {"src/sub"}},
+    {"added back",
+     [] {
+         writeFile("src/b.h", "#include \"a.h\"\nclass B : public A {};\n");
+     },
+     {"src/b.h"}},
+    {"main moved",
+     [] {
+         writeFile("test/t_a.cpp", "#include \"src/b.h\"\n");
+         writeFile("test/t_c.cpp", "#include \"src/c.h\"\n"
+                                   "class D : public C {};\n"
+                                   "int main() { return 0; }\n");
+     },
+     {"test/t_a.cpp", "test/t_c.cpp"}},
+};
+
+void writeFixtures()
+{
+    create_directories(root + "/src/sub");
+    create_directories(root + "/test");
+    // left by the previous run
+    removeFile("src/d.h");
+    writeFile("src/a.h", "class A { public: void f(); void g(); };\n"
+                         "#include \"a.tpp\"\n");
+    writeFile("src/a.tpp", "void A::g() {}\n");
+    writeFile("src/a.cpp", "#include \"a.h\"\nvoid A::f() { int a; }\n");
+    writeFile("src/b.h", "#include \"a.h\"\nclass B : public A {};\n");
+    writeFile("src/c.h", "int g();\n");
+    writeFile("src/c.cpp", "#include \"c.h\"\n#include \"sub/e.h\"\n"
+                           "int g() { return 1; }\n");
+    writeFile("src/sub/e.h", "void e();\n");
+    writeFile("src/h.cpp", "int h() { return 2; }\n");
+    writeFile("test/t_a.cpp",
+              "#include \"src/b.h\"\nint main() { return 0; }\n");
+    writeFile("test/t_c.cpp", "#include \"src/c.h\"\n");
+}
+
+// the explicit dependencies and the flags, by file name
+std::map< std::string, std::string > describe(const FileTree &tree)
+{
+    std::map< std::string, std::string > result;
+    for (const FileNode *file : tree.rootNode()->getFiles()) {
+        std::set< std::string > deps;
+        for (const FileNode *dep : file->_setExplicitDependencies)
+            deps.insert(dep->name());
+        std::set< std::string > dependentBy;
+        for (const FileNode *dep : file->_setExplicitDependendentBy)
+            dependentBy.insert(dep->name());
+
+        std::string &description = result[file->name()];
+        description += file->isSourceFile() ? " source" : "";
+        description += file->isTestFile() ? " test" : "";
+        description += file->isManuallyLabeled() ? " labeled" : "";
+        for (const std::string &dep : deps)
+            description += " >" + dep;
+        for (const std::string &dep : dependentBy)
+            description += " <" + dep;
+    }
+    return result;
+}
+
+int compare(const std::string &step,
+            const std::map< std::string, std::string > &updated,
+            const std::map< std::string, std::string > &built)
+{
+    if (updated == built)
+        return 0;
+    std::cout << "FAIL " << step << ": updated" << std::endl;
+    for (const auto &file : updated)
+        std::cout << "    " << file.first << ':' << file.second << std::endl;
+    std::cout << "  built" << std::endl;
+    for (const auto &file : built)
+        std::cout << "    " << file.first << ':' << file.second << std::endl;
+    return 1;
+}
+
+} // namespace
+
+int testResidentTree()
+{
+    writeFixtures();
+
+    CommandLineArgs clargs;
+    std::string outDir = root + "_out";
+    const char *argv[] = {"lazyut", "-r",          root.c_str(),
+                          "-o",     outDir.c_str(), "-s",
+                          "src",    "-t",          "test"};
+    clargs.parseArguments(sizeof(argv) / sizeof(argv[0]),
+                          const_cast< char ** >(argv));
+
+    ResidentTree resident(clargs);
+    resident.refresh();
+
+    int failures = 0;
+    for (const Step &step : steps) {
+        step.change();
+        std::vector< SplittedPath > paths;
+        for (const std::string &path : step.paths)
+            paths.push_back(SplittedPath(path, SplittedPath::unixSep()));
+        resident.refresh(paths);
+
+        ResidentTree built(clargs);
+        built.refresh();
+        failures += compare(step.name, describe(resident.tree()),
+                            describe(built.tree()));
+    }
+    return failures;
+}
@@ -0,0 +1,9 @@
+#ifndef RESIDENT_TREE_TEST_H
+#define RESIDENT_TREE_TEST_H
+
+// ResidentTree updated in place while the files change against a tree
+// built again from scratch after each change; returns the number of
+// failed steps
+int testResidentTree();
+
+#endif // RESIDENT_TREE_TEST_H
@@ -0,0 +1,416 @@
+#include "tokenizer_test.h"
+
+#include <extensions/help_functions.hpp>
+#include <parsers/sourceparser.hpp>
+#include <parsers/tokenizer.hpp>
+#include <types/file_tree.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Lexeme
+{
+    TokenName name;
+    size_t offset;
+    size_t length;
+    unsigned line;
+
+    bool operator==(const Lexeme &other) const
+    {
+        return name == other.name && offset == other.offset &&
+               length == other.length && line == other.line;
+    }
+    bool operator!=(const Lexeme &other) const { return !(*this == other); }
+};
+
+bool isTextual(char ch)
+{
+    return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') ||
+           (ch >= '0' && ch <= '9') || ch == '_';
+}
+
+bool isSpace(char ch) { return ch == ' ' || (ch >= '\t' && ch <= '\r'); }
+
+// the length bytes from s start a special symbol
+bool isSymbolPrefix(const char *s, size_t length)
+{
+    for (int i = 0; i < special_symbols.size(); ++i) {
+        const char *symbol = special_symbols[i].second;
+        if (strlen(symbol) >= length && memcmp(symbol, s, length) == 0)
+            return true;
+    }
+    return false;
+}
+
+// the tokens as Tokenizer finds them, a byte at a time and with the
+// linear searches of the token maps instead of the scan, of the key word
+// table and of the symbol automaton
+std::vector< Lexeme > referenceTokens(const std::string &text)
+{
+    std::vector< Lexeme > tokens;
+    const char *begin = text.data();
+    const char *end = begin + text.size();
+    const char *linesCountedTo = begin;
+    unsigned line = 1;
+    auto add = [&](TokenName name, const char *s, size_t length) {
+        for (; linesCountedTo < s; ++linesCountedTo) {
+            if (*linesCountedTo == '\n')
+                ++line;
+        }
+        tokens.push_back({name, size_t(s - begin), length, line});
+    };
+
+    const char *p = begin;
+    while (p < end) {
+        if (isSpace(*p)) {
+            ++p;
+            continue;
+        }
+        if (isTextual(*p)) {
+            const char *q = p;
+            while (q < end && isTextual(*q))
+                ++q;
+            if (q == end)
+                break;
+            const TokenName name = key_words.findToken(p, q - p);
+            add(name == TokenName::Undefined ? TokenName::Identifier : name, p,
+                q - p);
+            p = q;
+            continue;
+        }
+
+        size_t prefix = 0;
+        while (p + prefix < end && isSymbolPrefix(p, prefix + 1))
+            ++prefix;
+        if (p + prefix == end)
+            break;
+        if (prefix == 0) {
+            ++p;
+            continue;
+        }
+        size_t length = prefix;
+        TokenName name;
+        while ((name = special_symbols.findToken(p, length)) ==
+               TokenName::Undefined)
+            --length;
+        const char *s = p;
+        p += length;
+
+        if (name == TokenName::SingleQuote || name == TokenName::DoubleQuote) {
+            const char quote = name == TokenName::SingleQuote ? '\'' : '\"';
+            const char *q = p;
+            while (q < end && *q != quote)
+                q += *q == '\\' ? 2 : 1;
+            if (q > end)
+                q = end;
+            add(TokenName::String, s + 1, q - p);
+            p = q < end ? q + 1 : end;
+            linesCountedTo = p;
+        }
+        else if (name == TokenName::DoubleSlash) {
+            while (p < end && (*p != '\n' || p[-1] == '\\'))
+                ++p;
+            if (p < end)
+                ++p;
+        }
+        else if (name == TokenName::SlashStar) {
+            while (p < end && !(*p == '*' && p + 1 < end && p[1] == '/'))
+                ++p;
+            p = p < end ? p + 2 : end;
+        }
+        else {
+            add(name, s, length);
+        }
+    }
+    return tokens;
+}
+
+// followed by a zero byte, as the files read
+FileData fileData(const std::string &text)
+{
+    std::shared_ptr< char > data(new char[text.size() + 1],
+                                 std::default_delete< char[] >());
+    memcpy(data.get(), text.c_str(), text.size() + 1);
+    return FileData(data, text.size());
+}
+
+const SplittedPath testPath("tokenizer_test.cpp", SplittedPath::unixSep());
+
+std::vector< Lexeme > tokenize(const std::string &text,
+                               bool *isSkipped = nullptr)
+{
+    Tokenizer tokenizer;
+    tokenizer.open(testPath, fileData(text));
+    std::vector< Lexeme > tokens;
+    Token token(TokenName::Undefined, 0, 0);
+    while (tokenizer.next(token))
+        tokens.push_back(
+            {token.name, token.offset, token.length, tokenizer.line()});
+    if (isSkipped)
+        *isSkipped = tokenizer.isSkipped();
+    return tokens;
+}
+
+std::string toString(const std::string &text, const Lexeme &lexeme)
+{
+    std::stringstream ss;
+    ss << '\'' << text.substr(lexeme.offset, lexeme.length) << "' "
+       << ttos(lexeme.name) << " at " << lexeme.offset << " line "
+       << lexeme.line;
+    return ss.str();
+}
+
+int check(const std::string &name, const std::string &text)
+{
+    const std::vector< Lexeme > tokens = tokenize(text);
+    const std::vector< Lexeme > reference = referenceTokens(text);
+    size_t i = 0;
+    while (i < tokens.size() && i < reference.size() &&
+           tokens[i] == reference[i])
+        ++i;
+    if (i == tokens.size() && i == reference.size())
+        return 0;
+
+    std::cout << "FAIL " << name << ": token " << i << " is "
+              << (i < tokens.size() ? toString(text, tokens[i]) : "none")
+              << ", expected "
+              << (i < reference.size() ? toString(text, reference[i]) : "none")
+              << std::endl;
+    return 1;
+}
+
+// every token ends the text in one of the prefixes
+const char *const texts[] = {
+    "class A : public B\r\n{\r\n    int f(int a) const;\r\n};\r\n",
+    "struct S\r{ int a; }\r;\rnamespace n { using T = S; }\n",
+    "a >>= b; c >> d; e <<= f; g->h; i::j; k != l;; m ||\\\n n",
+    "s = \"q\\\"\r\n\\\\\"; t = '\\''; u = \"\"; v = '\\\\'\n",
+    "// comment \\\r\n continued\r\nw; /* block * / */ x; /**/ y\n",
+    "operator<<=(typename T::U &&u) { return template_ + 1e5; }\n",
+    "caf\xc3\xa9 = 1; @ $ ` \x7f\x80\xff z\n",
+    "#include <a.h>\n#include \"b.h\"\n#define M(x) #x\n",
+    "unterminated \"string\\",
+    "unterminated /* comment",
+    "unterminated // comment \\",
+    "a ->",
+    "a>>",
+    "a;",
+    "identifier",
+    "",
+};
+
+// pieces of the random texts
+const char *const pieces[] = {
+    "class",     "struct",    "namespace", "template",  "typename",
+    "public",    "virtual",   "operator",  "constexpr", "_",
+    "x",         "ab1",       "classes",   "Class",     "a_very_long_name",
+    "0x1f",      " ",         " ",         "\t",        "\n",
+    "\r\n",      "\r",        "\v\f",      ";",         "::",
+    ":",         "->",        "-",         ">",         ">>",
+    ">>=",       "<<=",       "<",         "=",         "==",
+    "!",         "&&",        "|",         "{",         "}",
+    "(",         ")",         "#",         ".",         ",",
+    "@",         "\xc3\xa9",  "\"",        "'",         "\\",
+    "\"s\"",     "'c'",       "\"\\\"\"",  "//",        "// c\n",
+    "/*",        "*/",        "/* c */",   "*",         "/",
+};
+
+struct LimitCase
+{
+    const char *name;
+    std::string text;
+    bool isSkipped;
+    // the lengths of the tokens read
+    std::vector< size_t > lengths;
+};
+
+int checkLimits()
+{
+    const size_t max = Tokenizer::maxLength;
+    const LimitCase cases[] = {
+        {"longest name", "a " + std::string(max, 'b') + " ;\n", false,
+         {1, max, 1}},
+        {"name too long", "a " + std::string(max + 1, 'b') + " c;", true, {1}},
+        {"longest string", "a \"" + std::string(max, 's') + "\";\n", false,
+         {1, max, 1}},
+        {"string too long", "a \"" + std::string(max + 1, 's') + "\";", true,
+         {1}},
+    };
+    int failures = 0;
+    for (const LimitCase &c : cases) {
+        bool isSkipped = false;
+        std::vector< size_t > lengths;
+        for (const Lexeme &lexeme : tokenize(c.text, &isSkipped))
+            lengths.push_back(lexeme.length);
+        if (isSkipped != c.isSkipped || lengths != c.lengths) {
+            std::cout << "FAIL " << c.name << ": " << lengths.size()
+                      << " tokens" << (isSkipped ? ", skipped" : "")
+                      << std::endl;
+            ++failures;
+        }
+    }
+
+    // the size is checked before the text is read
+    if (sizeof(size_t) > sizeof(uint32_t)) {
+        FileData huge = fileData("a;");
+        huge.size = Tokenizer::maxOffset + 1;
+        Tokenizer tokenizer;
+        tokenizer.open(testPath, huge);
+        Token token(TokenName::Undefined, 0, 0);
+        if (tokenizer.next(token) || !tokenizer.isSkipped()) {
+            std::cout << "FAIL file too large: not skipped" << std::endl;
+            ++failures;
+        }
+    }
+
+    // nothing is taken from a skipped file
+    const std::string root = "tokenizer_fixtures";
+    create_directories(root);
+    std::ofstream(root + "/inc.h");
+    std::ofstream(root + "/long.cpp")
+        << "#include \"inc.h\"\nclass A;\nconst char *s = \""
+        << std::string(max + 1, 's') << "\";\n";
+    FileTree tree;
+    tree.setRootPath(SplittedPath(root, SplittedPath::unixSep()));
+    tree.readSources({SplittedPath()}, {});
+    FileNode *node =
+        tree.searchInRoot(SplittedPath("long.cpp", SplittedPath::unixSep()));
+    if (node) {
+        SourceParser(tree).parseFile(node);
+        if (!node->record()._listIncludes.empty() ||
+            !node->record()._setClassDecl.empty()) {
+            std::cout << "FAIL skipped file: parsed" << std::endl;
+            ++failures;
+        }
+    }
+    else {
+        std::cout << "FAIL skipped file: not read" << std::endl;
+        ++failures;
+    }
+    return failures;
+}
+
+bool isToken(TokenStream &stream, int i, TokenName name, size_t offset,
+             size_t length, unsigned line)
+{
+    return stream[i].name == name && stream[i].offset == offset &&
+           stream[i].length == length && stream.line(i) == line;
+}
+
+// TokenStream against all the tokens of a text longer than its ring, read
+// ahead and back as the parser reads them
+int checkStream()
+{
+    std::string text;
+    for (int i = 0; i < 3000; ++i)
+        text += "class C" + std::to_string(i) + " : public B< T, " +
+                std::to_string(i) + " > {};\n";
+    const std::vector< Lexeme > tokens = tokenize(text);
+    const int count = static_cast< int >(tokens.size());
+
+    TokenStream stream;
+    stream.open(testPath, fileData(text));
+    unsigned seed = 24;
+    auto random = [&seed](int bound) {
+        seed = seed * 1103515245u + 12345u;
+        return static_cast< int >((seed >> 16) % bound);
+    };
+    int failures = 0;
+    auto check = [&](const char *what, int i, TokenName name, size_t offset,
+                     size_t length, unsigned line) {
+        if (isToken(stream, i, name, offset, length, line))
+            return;
+        std::cout << "FAIL stream: " << what << ' ' << i << " of " << count
+                  << " is " << ttos(stream[i].name) << " at "
+                  << stream[i].offset << " line " << stream.line(i)
+                  << std::endl;
+        ++failures;
+    };
+    for (int i = 0; stream.has(i) && failures < 10; ++i) {
+        check("token", i, tokens[i].name, tokens[i].offset, tokens[i].length,
+              tokens[i].line);
+        stream.has(i + random(64));
+        const int back = stream.first() + random(i - stream.first() + 1);
+        check("token back", back, tokens[back].name, tokens[back].offset,
+              tokens[back].length, tokens[back].line);
+    }
+    if (count <= TokenStream::lookback || stream.has(count) ||
+        stream.first() != count - TokenStream::lookback) {
+        std::cout << "FAIL stream: " << count << " tokens, the ring from "
+                  << stream.first() << std::endl;
+        ++failures;
+    }
+    // before the kept tokens and past the end of the file
+    check("forgotten", stream.first() - 1, TokenName::Undefined, 0, 0, 0);
+    check("past the end", count, TokenName::Undefined, 0, 0,
+          tokens.back().line);
+    check("far past the end", count + TokenStream::lookback,
+          TokenName::Undefined, 0, 0, tokens.back().line);
+
+    // every declaration of a file longer than the ring is found
+    const std::string root = "tokenizer_fixtures";
+    create_directories(root);
+    std::ofstream(root + "/long.h") << text;
+    std::ofstream(root + "/hash_at_end.cpp") << "class A {};\n#\n";
+    FileTree tree;
+    tree.setRootPath(SplittedPath(root, SplittedPath::unixSep()));
+    tree.readSources({SplittedPath()}, {});
+    SourceParser parser(tree);
+    for (const char *name : {"long.h", "hash_at_end.cpp"}) {
+        FileNode *node =
+            tree.searchInRoot(SplittedPath(name, SplittedPath::unixSep()));
+        if (!node) {
+            std::cout << "FAIL " << name << ": not read" << std::endl;
+            ++failures;
+            continue;
+        }
+        parser.parseFile(node);
+        const size_t classCount = node->record()._setClassDecl.size();
+        if (classCount != (name == std::string("long.h") ? 3000u : 1u)) {
+            std::cout << "FAIL " << name << ": " << classCount
+                      << " classes declared" << std::endl;
+            ++failures;
+        }
+    }
+    return failures;
+}
+
+} // namespace
+
+int testTokenizer()
+{
+    int failures = 0;
+    int i = 0;
+    for (const char *text : texts) {
+        // every token at every position of a 16-byte block
+        for (int shift = 0; shift < 33; ++shift) {
+            const std::string name =
+                "text " + std::to_string(i) + " shift " + std::to_string(shift);
+            failures += check(name, std::string(shift, ' ') + text);
+            failures += check(name + " after a name",
+                              std::string(shift, 'x') + ' ' + text);
+        }
+        ++i;
+    }
+
+    // the same texts on every platform
+    unsigned seed = 21;
+    auto random = [&seed](size_t bound) {
+        seed = seed * 1103515245u + 12345u;
+        return static_cast< size_t >((seed >> 16) % bound);
+    };
+    const size_t pieceCount = sizeof(pieces) / sizeof(pieces[0]);
+    for (i = 0; i < 300; ++i) {
+        std::string text;
+        for (size_t n = random(400); n > 0; --n)
+            text += pieces[random(pieceCount)];
+        failures += check("random text " + std::to_string(i), text);
+    }
+    return failures + checkLimits() + checkStream();
+}
@@ -0,0 +1,10 @@
+#ifndef TOKENIZER_TEST_H
+#define TOKENIZER_TEST_H
+
+// Tokenizer against a byte by byte tokenizer on the same texts, shifted
+// over the 16-byte blocks of the scan, and on the files and tokens too
+// large for a Token; TokenStream against all the tokens of a file longer
+// than its ring. Returns the number of failed cases
+int testTokenizer();
+
+#endif // TOKENIZER_TEST_H